@@ -113,6 +113,16 @@ public:
             this->Zoom = 45.0f;
     }
 
+    // Restores a recorded pose, e.g. when replaying a session
+    void SetState(glm::vec3 position, GLfloat yaw, GLfloat pitch, GLfloat zoom)
+    {
+        this->Position = position;
+        this->Yaw = yaw;
+        this->Pitch = pitch;
+        this->Zoom = zoom;
+        this->updateCameraVectors();
+    }
+
 private:
     // Calculates the front vector from the Camera's (updated) Eular Angles
     void updateCameraVectors()
@@ -0,0 +1,440 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+// SGP4 Includes
+#include <Tle.h>
+#include <SGP4.h>
+
+#include "OrbitMath.h"
+#include "Metrics.h"
+
+// Catalog arrays are released by dropping the arena, so propagators must not need destructors
+static_assert(std::is_trivially_destructible<libsgp4::SGP4>::value, "SGP4 must be trivially destructible to live in an arena");
+
+// Bump allocator over a single cache-line aligned block. Freeing the arena releases everything at once.
+class Arena
+{
+public:
+    static const size_t ALIGNMENT = 64;
+
+    Arena() : base(nullptr), capacity(0), offset(0) {}
+    explicit Arena(size_t bytes) : base(nullptr), capacity(0), offset(0) { this->Reserve(bytes); }
+    ~Arena() { this->Release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept : base(other.base), capacity(other.capacity), offset(other.offset)
+    {
+        other.base = nullptr;
+        other.capacity = other.offset = 0;
+    }
+    Arena& operator=(Arena&& other) noexcept
+    {
+        if (this != &other)
+        {
+            this->Release();
+            this->base = other.base;
+            this->capacity = other.capacity;
+            this->offset = other.offset;
+            other.base = nullptr;
+            other.capacity = other.offset = 0;
+        }
+        return *this;
+    }
+
+    // Drops the current block and allocates a new one of the given size
+    void Reserve(size_t bytes)
+    {
+        this->Release();
+        if (bytes == 0)
+            return;
+        this->base = static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+        this->capacity = bytes;
+    }
+
+    void* Allocate(size_t bytes, size_t alignment)
+    {
+        size_t start = (this->offset + alignment - 1) & ~(alignment - 1);
+        if (start + bytes > this->capacity)
+            throw std::bad_alloc();
+        this->offset = start + bytes;
+        return this->base + start;
+    }
+
+    template <typename T>
+    T* AllocateArray(size_t count, size_t alignment = alignof(T))
+    {
+        return static_cast<T*>(this->Allocate(count * sizeof(T), alignment));
+    }
+
+    // Copies a string into the arena and returns a view of the copy
+    std::string_view Store(const std::string& text)
+    {
+        char* dst = this->AllocateArray<char>(text.size());
+        std::memcpy(dst, text.data(), text.size());
+        return std::string_view(dst, text.size());
+    }
+
+    // O(1): the whole block goes back in one call, nothing is destroyed individually
+    void Release()
+    {
+        if (this->base)
+            ::operator delete(this->base, std::align_val_t(ALIGNMENT));
+        this->base = nullptr;
+        this->capacity = this->offset = 0;
+    }
+
+    size_t Used() const { return this->offset; }
+    size_t Capacity() const { return this->capacity; }
+
+    // Upper bound for an allocation of count objects of type T, including alignment padding
+    template <typename T>
+    static size_t Footprint(size_t count, size_t alignment = alignof(T))
+    {
+        return count * sizeof(T) + alignment;
+    }
+
+private:
+    unsigned char* base;
+    size_t capacity;
+    size_t offset;
+};
+
+// Generational reference to a catalog object. Stays valid across reloads as long as the NORAD number is still present.
+struct CatalogHandle
+{
+    uint32_t slot;
+    uint32_t generation;
+
+    bool operator==(const CatalogHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const CatalogHandle& other) const { return !(*this == other); }
+};
+
+const CatalogHandle INVALID_CATALOG_HANDLE = { 0xFFFFFFFFu, 0 };
+
+// Cold metadata, only touched by UI and export code
+struct CatalogEntryInfo
+{
+    std::string_view name;
+    std::string_view line1;
+    std::string_view line2;
+    std::string_view designator;
+};
+
+// Satellite catalog stored in two per-catalog arenas:
+//  - hot:  SGP4 propagators, epochs and NORAD numbers in contiguous aligned arrays
+//  - cold: names, raw TLE lines and international designators
+class Catalog
+{
+public:
+    Catalog() : count(0), parseErrors(0), propagators(nullptr), epochDays(nullptr), noradNumbers(nullptr), slotOf(nullptr), info(nullptr) {}
+
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    // Loads a 2-line or 3-line TLE file, replacing the current contents. Returns false if the file can't be read.
+    bool LoadFromFile(const std::string& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::CATALOG::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return false;
+        }
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+                line.pop_back();
+            if (!line.empty())
+                lines.push_back(line);
+        }
+        this->LoadFromLines(lines);
+        return true;
+    }
+
+    // Parses TLE records from already split lines. Malformed records are counted and skipped.
+    void LoadFromLines(const std::vector<std::string>& lines)
+    {
+        std::vector<PendingEntry> parsed;
+        parsed.reserve(lines.size() / 2);
+        size_t errors = 0;
+
+        for (size_t i = 0; i < lines.size();)
+        {
+            std::string name;
+            if (!IsTleLine(lines[i], '1'))
+            {
+                name = lines[i];
+                if (name.compare(0, 2, "0 ") == 0)
+                    name = name.substr(2);
+                ++i;
+            }
+            if (i + 1 >= lines.size() || !IsTleLine(lines[i], '1') || !IsTleLine(lines[i + 1], '2'))
+            {
+                // Step past a line 1 and its truncated line 2, so the next record starts on a fresh line
+                if (i < lines.size() && IsTleLine(lines[i], '1'))
+                    ++i;
+                if (i < lines.size() && lines[i].compare(0, 2, "2 ") == 0)
+                    ++i;
+                ++errors;
+                continue;
+            }
+            try
+            {
+                libsgp4::Tle tle(name, lines[i], lines[i + 1]);
+                parsed.push_back({ tle, libsgp4::SGP4(tle), tle_line1_epoch_days(lines[i]) });
+            }
+            catch (const std::exception& e)
+            {
+                std::cout << "ERROR::CATALOG::TLE_PARSE_FAILED " << name << ": " << e.what() << std::endl;
+                ++errors;
+            }
+            i += 2;
+        }
+
+        this->Rebuild(parsed);
+        this->parseErrors = errors;
+        Metrics::Instance().Set(METRIC_CATALOG_OBJECTS, (int64_t)this->count);
+        Metrics::Instance().Set(METRIC_TLE_PARSE_ERRORS, (int64_t)errors);
+    }
+
+    // Drops every object; the arenas go back in two deallocations. All outstanding handles become invalid.
+    void Clear()
+    {
+        for (size_t i = 0; i < this->count; ++i)
+            this->FreeSlot(this->slotOf[i]);
+        this->slotByNorad.clear();
+        this->hot.Release();
+        this->cold.Release();
+        this->count = 0;
+        this->propagators = nullptr;
+        this->epochDays = nullptr;
+        this->noradNumbers = nullptr;
+        this->slotOf = nullptr;
+        this->info = nullptr;
+    }
+
+    size_t Size() const { return this->count; }
+    size_t ParseErrors() const { return this->parseErrors; }
+
+    // Handle lookups
+    CatalogHandle Find(uint32_t noradNumber) const
+    {
+        auto it = this->slotByNorad.find(noradNumber);
+        if (it == this->slotByNorad.end())
+            return INVALID_CATALOG_HANDLE;
+        return { it->second, this->slots[it->second].generation };
+    }
+    CatalogHandle HandleAt(size_t index) const
+    {
+        uint32_t slot = this->slotOf[index];
+        return { slot, this->slots[slot].generation };
+    }
+    bool IsValid(CatalogHandle handle) const
+    {
+        return handle.slot < this->slots.size() && this->slots[handle.slot].generation == handle.generation &&
+               this->slots[handle.slot].index != NO_INDEX;
+    }
+    // Dense index of a handle, only meaningful until the next reload
+    size_t IndexOf(CatalogHandle handle) const
+    {
+        if (!this->IsValid(handle))
+            throw std::out_of_range("Stale catalog handle");
+        return this->slots[handle.slot].index;
+    }
+
+    // Hot data
+    const libsgp4::SGP4& PropagatorAt(size_t index) const { return this->propagators[index]; }
+    double EpochDaysAt(size_t index) const { return this->epochDays[index]; }
+    uint32_t NoradNumberAt(size_t index) const { return this->noradNumbers[index]; }
+
+    // SGP4 state of an object at the given day (days since 2000-01-01, as returned by calculate_days)
+    libsgp4::Eci FindPosition(size_t index, double days) const
+    {
+        Metrics::Instance().Add(METRIC_PROPAGATIONS);
+        return this->propagators[index].FindPosition((days - this->epochDays[index]) * 1440.0);
+    }
+
+    // Scene-frame positions (see eci_to_scene) of every object at the given day. Objects that fail to
+    // propagate (decayed, invalid elements) keep their previous value. Returns the number of failures.
+    size_t PropagateScene(double days, glm::vec3* out) const
+    {
+        return this->PropagateScene(days, 0, this->count, out);
+    }
+
+    // Same for objects [begin, end); out[0] belongs to object begin
+    size_t PropagateScene(double days, size_t begin, size_t end, glm::vec3* out) const
+    {
+        size_t failures = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            try
+            {
+                out[i - begin] = eci_to_scene(this->FindPosition(i, days), days);
+            }
+            catch (const std::exception&)
+            {
+                ++failures;
+            }
+        }
+        Metrics::Instance().Add(METRIC_PROPAGATION_FAILURES, failures);
+        return failures;
+    }
+
+    // Cold data
+    const CatalogEntryInfo& InfoAt(size_t index) const { return this->info[index]; }
+
+    // Memory accounting
+    size_t HotBytes() const { return this->hot.Used(); }
+    size_t ColdBytes() const { return this->cold.Used(); }
+    size_t BytesPerObject() const
+    {
+        if (this->count == 0)
+            return 0;
+        size_t bookkeeping = this->slots.capacity() * sizeof(Slot) +
+                             this->slotByNorad.size() * (sizeof(uint32_t) * 2 + sizeof(void*)) +
+                             this->slotByNorad.bucket_count() * sizeof(void*);
+        return (this->hot.Used() + this->cold.Used() + bookkeeping) / this->count;
+    }
+
+private:
+    static const uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+    struct PendingEntry
+    {
+        libsgp4::Tle tle;
+        libsgp4::SGP4 sgp4;
+        double epoch;
+    };
+
+    struct Slot
+    {
+        uint32_t generation;
+        uint32_t index;
+    };
+
+    size_t count;
+    size_t parseErrors;
+
+    Arena hot;
+    Arena cold;
+    libsgp4::SGP4* propagators;
+    double* epochDays;
+    uint32_t* noradNumbers;
+    uint32_t* slotOf;
+    CatalogEntryInfo* info;
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<uint32_t, uint32_t> slotByNorad;
+
+    static bool IsTleLine(const std::string& line, char number)
+    {
+        return line.size() >= 69 && line[0] == number && line[1] == ' ';
+    }
+
+    uint32_t AcquireSlot()
+    {
+        if (!this->freeSlots.empty())
+        {
+            uint32_t slot = this->freeSlots.back();
+            this->freeSlots.pop_back();
+            return slot;
+        }
+        this->slots.push_back({ 0, NO_INDEX });
+        return static_cast<uint32_t>(this->slots.size() - 1);
+    }
+
+    void FreeSlot(uint32_t slot)
+    {
+        this->slots[slot].index = NO_INDEX;
+        ++this->slots[slot].generation;
+        this->freeSlots.push_back(slot);
+    }
+
+    // Builds fresh arenas for n objects, keeping slots of NORAD numbers that survive the reload
+    void Rebuild(const std::vector<PendingEntry>& entries)
+    {
+        size_t n = entries.size();
+        size_t coldBytes = Arena::Footprint<CatalogEntryInfo>(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const libsgp4::Tle& tle = entries[i].tle;
+            coldBytes += tle.Name().size() + tle.Line1().size() + tle.Line2().size() + tle.IntDesignator().size();
+        }
+        Arena newHot(Arena::Footprint<libsgp4::SGP4>(n, Arena::ALIGNMENT) + Arena::Footprint<double>(n, Arena::ALIGNMENT) +
+                     Arena::Footprint<uint32_t>(n, Arena::ALIGNMENT) * 2);
+        Arena newCold(coldBytes);
+
+        libsgp4::SGP4* newPropagators = newHot.AllocateArray<libsgp4::SGP4>(n, Arena::ALIGNMENT);
+        double* newEpochs = newHot.AllocateArray<double>(n, Arena::ALIGNMENT);
+        uint32_t* newNorad = newHot.AllocateArray<uint32_t>(n, Arena::ALIGNMENT);
+        uint32_t* newSlotOf = newHot.AllocateArray<uint32_t>(n, Arena::ALIGNMENT);
+        CatalogEntryInfo* newInfo = newCold.AllocateArray<CatalogEntryInfo>(n);
+
+        // Objects that vanish from the new catalog invalidate their handles
+        std::unordered_map<uint32_t, uint32_t> survivors;
+        survivors.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            survivors.emplace(entries[i].tle.NoradNumber(), 0);
+        for (auto it = this->slotByNorad.begin(); it != this->slotByNorad.end();)
+        {
+            if (survivors.count(it->first) == 0)
+            {
+                this->FreeSlot(it->second);
+                it = this->slotByNorad.erase(it);
+            }
+            else
+            {
+                this->slots[it->second].index = NO_INDEX;
+                ++it;
+            }
+        }
+
+        size_t stored = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const libsgp4::Tle& tle = entries[i].tle;
+            uint32_t norad = tle.NoradNumber();
+            auto it = this->slotByNorad.find(norad);
+            if (it != this->slotByNorad.end() && this->slots[it->second].index != NO_INDEX)
+                continue; // duplicate NORAD number in the file, first record wins
+
+            new (&newPropagators[stored]) libsgp4::SGP4(entries[i].sgp4);
+            newEpochs[stored] = entries[i].epoch;
+            newNorad[stored] = norad;
+            newInfo[stored] = { newCold.Store(tle.Name()), newCold.Store(tle.Line1()), newCold.Store(tle.Line2()),
+                                newCold.Store(tle.IntDesignator()) };
+
+            uint32_t slot = it != this->slotByNorad.end() ? it->second : this->AcquireSlot();
+            this->slotByNorad[norad] = slot;
+            this->slots[slot].index = static_cast<uint32_t>(stored);
+            newSlotOf[stored] = slot;
+            ++stored;
+        }
+
+        this->hot = std::move(newHot);
+        this->cold = std::move(newCold);
+        this->count = stored;
+        this->propagators = newPropagators;
+        this->epochDays = newEpochs;
+        this->noradNumbers = newNorad;
+        this->slotOf = newSlotOf;
+        this->info = newInfo;
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <vector>
+
+// GL Includes
+#include <glm/glm/glm.hpp>
+
+// View frustum as six world-space planes (xyz normal pointing inwards, w distance)
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    // Gribb-Hartmann extraction from a combined projection * view matrix
+    explicit Frustum(const glm::mat4& viewProjection)
+    {
+        glm::mat4 m = glm::transpose(viewProjection);   // rows of the column-major matrix
+        this->planes[0] = m[3] + m[0];   // left
+        this->planes[1] = m[3] - m[0];   // right
+        this->planes[2] = m[3] + m[1];   // bottom
+        this->planes[3] = m[3] - m[1];   // top
+        this->planes[4] = m[3] + m[2];   // near
+        this->planes[5] = m[3] - m[2];   // far
+        for (glm::vec4& plane : this->planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    bool IntersectsSphere(const glm::vec3& center, float radius) const
+    {
+        for (const glm::vec4& plane : this->planes)
+        {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+};
+
+// True if the segment from the eye to the point passes through the Earth (a sphere at the world origin).
+// With the eye inside the sphere every segment would, so nothing counts as occluded then.
+inline bool occluded_by_earth(const glm::vec3& eye, const glm::vec3& point, float earthRadius)
+{
+    float r2 = earthRadius * earthRadius;
+    if (glm::dot(eye, eye) <= r2)
+        return false;
+    glm::vec3 d = point - eye;
+    float dd = glm::dot(d, d);
+    float t = dd > 0.0f ? glm::clamp(-glm::dot(eye, d) / dd, 0.0f, 1.0f) : 0.0f;
+    glm::vec3 closest = eye + t * d;
+    return glm::dot(closest, closest) < r2;
+}
+
+// Per-frame culling and LOD for catalog objects, run after propagation.
+//
+// Objects outside the frustum or hidden behind the Earth are dropped. Survivors are compacted into two
+// lists of scene-frame positions: objects whose projected size reaches PointThresholdPixels are drawn as
+// cube meshes, smaller ones as single point sprites. Both lists are uploaded as-is to the instance buffer.
+class SatelliteCuller
+{
+public:
+    // Objects smaller than this on screen (diameter, pixels) become point sprites
+    float PointThresholdPixels;
+
+    SatelliteCuller() : PointThresholdPixels(3.0f), culled(0), occluded(0) {}
+
+    // objectRadius and earthRadius are in world units (after `model`)
+    void Cull(const glm::vec3* positions, size_t count, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection,
+              const glm::vec3& eye, float objectRadius, float earthRadius, int viewportHeight)
+    {
+        this->cubes.clear();
+        this->points.clear();
+        this->culled = 0;
+        this->occluded = 0;
+
+        glm::mat4 viewProjection = projection * view;
+        Frustum frustum(viewProjection);
+        // Projected diameter in pixels is objectRadius * pixelScale / clip.w
+        float pixelScale = projection[1][1] * viewportHeight;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            glm::vec3 world = glm::vec3(model * glm::vec4(positions[i], 1.0f));
+            if (!frustum.IntersectsSphere(world, objectRadius))
+            {
+                ++this->culled;
+                continue;
+            }
+            if (occluded_by_earth(eye, world, earthRadius))
+            {
+                ++this->occluded;
+                continue;
+            }
+            float w = (viewProjection * glm::vec4(world, 1.0f)).w;
+            if (w > 0.0f && objectRadius * pixelScale / w < this->PointThresholdPixels)
+                this->points.push_back(positions[i]);
+            else
+                this->cubes.push_back(positions[i]);
+        }
+    }
+
+    const std::vector<glm::vec3>& Cubes() const { return this->cubes; }
+    const std::vector<glm::vec3>& Points() const { return this->points; }
+    size_t Culled() const { return this->culled; }
+    size_t Occluded() const { return this->occluded; }
+
+private:
+    std::vector<glm::vec3> cubes;
+    std::vector<glm::vec3> points;
+    size_t culled;
+    size_t occluded;
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/type_ptr.hpp>
+
+#include <imgui.h>
+
+#include "Shader.h"
+#include "Culling.h"
+#include "Metrics.h"
+
+// One satellite name to place next to its dot
+struct Label
+{
+    glm::vec3 position;     // world-space anchor
+    std::string_view text;  // must stay alive until the next Update()
+    float priority;         // higher wins a contested spot; the selected satellite should be highest
+    glm::vec4 color;
+};
+
+// Draws every visible label as one instanced quad draw using glyphs from ImGui's font atlas.
+// Which labels are shown is decided on a screen-space occupancy grid, and that layout is only
+// recomputed when the camera or the selection moves; anchors are re-uploaded every frame.
+class LabelRenderer
+{
+public:
+    // Occupancy grid cell, pixels
+    float CellSize;
+    // Largest view-projection element change that still reuses the previous layout
+    float CameraThreshold;
+    // Satellites keep moving under a still camera, so the layout also expires after this many seconds
+    double RefreshInterval;
+    // Text position relative to the projected anchor, pixels
+    glm::vec2 Offset;
+
+    LabelRenderer()
+        : CellSize(8.0f), CameraThreshold(0.01f), RefreshInterval(0.25), Offset(8.0f, 0.0f),
+          VAO(0), instanceVBO(0), anchorBuffer(0), anchorTexture(0), fontSize(0.0f), layoutValid(false),
+          layoutSelection(0), layoutTime(0.0), layoutCount(0), instanceCount(0)
+    {
+    }
+
+    // Updates anchors and, if needed, the decluttered layout. The sphere (origin, occluderRadius) hides labels behind it.
+    void Update(const std::vector<Label>& labels, const glm::mat4& viewProjection, const glm::vec3& eye, int width, int height,
+                uint64_t selection, double time, float occluderRadius)
+    {
+        if (!this->VAO)
+            this->Init();
+
+        if (this->NeedsLayout(labels.size(), viewProjection, selection, time))
+        {
+            this->Layout(labels, viewProjection, eye, width, height, occluderRadius);
+            this->layoutValid = true;
+            this->layoutViewProjection = viewProjection;
+            this->layoutSelection = selection;
+            this->layoutTime = time;
+            this->layoutCount = labels.size();
+        }
+
+        // Glyph instances reference anchors by slot, so moving satellites only cost one small upload
+        this->anchors.resize(this->visible.size());
+        for (size_t slot = 0; slot < this->visible.size(); ++slot)
+            this->anchors[slot] = glm::vec4(labels[this->visible[slot]].position, 1.0f);
+        glBindBuffer(GL_TEXTURE_BUFFER, this->anchorBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, this->anchors.size() * sizeof(glm::vec4), this->anchors.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        Metrics::Instance().Add(METRIC_UPLOAD_BYTES, this->anchors.size() * sizeof(glm::vec4));
+    }
+
+    void Draw(Shader& shader, const glm::mat4& viewProjection, int width, int height)
+    {
+        if (this->instanceCount == 0)
+            return;
+        shader.Use();
+        glUniformMatrix4fv(glGetUniformLocation(shader.Program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniform2f(glGetUniformLocation(shader.Program, "viewport"), (GLfloat)width, (GLfloat)height);
+        glUniform1i(glGetUniformLocation(shader.Program, "atlas"), 0);
+        glUniform1i(glGetUniformLocation(shader.Program, "anchors"), 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)ImGui::GetIO().Fonts->TexID);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, this->anchorTexture);
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBindVertexArray(this->VAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)this->instanceCount);
+        glBindVertexArray(0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    size_t VisibleCount() const { return this->visible.size(); }
+
+    void Release()
+    {
+        glDeleteVertexArrays(1, &this->VAO);
+        glDeleteBuffers(1, &this->instanceVBO);
+        glDeleteBuffers(1, &this->anchorBuffer);
+        glDeleteTextures(1, &this->anchorTexture);
+        this->VAO = this->instanceVBO = this->anchorBuffer = this->anchorTexture = 0;
+    }
+
+private:
+    struct Glyph
+    {
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+        float advance;
+    };
+
+    // Per-instance vertex data: one quad per glyph
+    struct GlyphInstance
+    {
+        GLfloat rect[4];   // pixel offset from the anchor (x, y down) and size
+        GLfloat uv[4];
+        GLfloat color[4];
+        GLfloat slot;      // index into the anchor buffer
+    };
+
+    static const int FIRST_CHAR = 32;
+    static const int LAST_CHAR = 126;
+
+    GLuint VAO, instanceVBO, anchorBuffer, anchorTexture;
+    Glyph glyphs[LAST_CHAR - FIRST_CHAR + 1];
+    float fontSize;
+
+    bool layoutValid;
+    glm::mat4 layoutViewProjection;
+    uint64_t layoutSelection;
+    double layoutTime;
+    size_t layoutCount;
+
+    std::vector<size_t> visible;        // label indices that won a spot, in slot order
+    std::vector<glm::vec4> anchors;
+    std::vector<GlyphInstance> instances;
+    std::vector<uint8_t> occupancy;
+    size_t instanceCount;
+
+    void Init()
+    {
+        // ImGui builds the atlas texture itself; we only need its glyph metrics
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        unsigned char* pixels;
+        int atlasWidth, atlasHeight;
+        atlas->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+        const ImFont* font = atlas->Fonts[0];
+        this->fontSize = font->FontSize;
+        for (int c = FIRST_CHAR; c <= LAST_CHAR; ++c)
+        {
+            const ImFontGlyph* g = font->FindGlyph((ImWchar)c);
+            Glyph& glyph = this->glyphs[c - FIRST_CHAR];
+            if (g)
+                glyph = { g->X0, g->Y0, g->X1, g->Y1, g->U0, g->V0, g->U1, g->V1, g->AdvanceX };
+            else
+                glyph = { 0, 0, 0, 0, 0, 0, 0, 0, this->fontSize * 0.5f };
+        }
+
+        glGenVertexArrays(1, &this->VAO);
+        glGenBuffers(1, &this->instanceVBO);
+        glGenBuffers(1, &this->anchorBuffer);
+        glGenTextures(1, &this->anchorTexture);
+
+        glBindVertexArray(this->VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (GLvoid*)offsetof(GlyphInstance, rect));
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (GLvoid*)offsetof(GlyphInstance, uv));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (GLvoid*)offsetof(GlyphInstance, color));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(GlyphInstance), (GLvoid*)offsetof(GlyphInstance, slot));
+        for (GLuint attribute = 0; attribute < 4; ++attribute)
+        {
+            glEnableVertexAttribArray(attribute);
+            glVertexAttribDivisor(attribute, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glBindBuffer(GL_TEXTURE_BUFFER, this->anchorBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, this->anchorTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->anchorBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    const Glyph& GlyphFor(char c) const
+    {
+        if (c < FIRST_CHAR || c > LAST_CHAR)
+            c = '?';
+        return this->glyphs[c - FIRST_CHAR];
+    }
+
+    bool NeedsLayout(size_t count, const glm::mat4& viewProjection, uint64_t selection, double time) const
+    {
+        if (!this->layoutValid || count != this->layoutCount || selection != this->layoutSelection ||
+            time - this->layoutTime > this->RefreshInterval)
+            return true;
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                if (std::fabs(viewProjection[column][row] - this->layoutViewProjection[column][row]) > this->CameraThreshold)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    void Layout(const std::vector<Label>& labels, const glm::mat4& viewProjection, const glm::vec3& eye, int width, int height,
+                float occluderRadius)
+    {
+        int columns = std::max(1, (int)std::ceil(width / this->CellSize));
+        int rows = std::max(1, (int)std::ceil(height / this->CellSize));
+        this->occupancy.assign((size_t)columns * rows, 0);
+        this->visible.clear();
+        this->instances.clear();
+
+        std::vector<size_t> order(labels.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return labels[a].priority > labels[b].priority; });
+
+        for (size_t index : order)
+        {
+            const Label& label = labels[index];
+            glm::vec4 clip = viewProjection * glm::vec4(label.position, 1.0f);
+            if (clip.w <= 0.0f)
+                continue;
+            float sx = (clip.x / clip.w * 0.5f + 0.5f) * width;
+            float sy = (0.5f - clip.y / clip.w * 0.5f) * height;
+            if (sx < 0.0f || sy < 0.0f || sx >= width || sy >= height)
+                continue;
+            if (occluderRadius > 0.0f && occluded_by_earth(eye, label.position, occluderRadius))
+                continue;
+
+            float textWidth = 0.0f;
+            for (char c : label.text)
+                textWidth += this->GlyphFor(c).advance;
+            float top = this->Offset.y - this->fontSize * 0.5f;
+            int c0 = std::max(0, (int)((sx + this->Offset.x) / this->CellSize));
+            int r0 = std::max(0, (int)((sy + top) / this->CellSize));
+            int c1 = std::min(columns - 1, (int)((sx + this->Offset.x + textWidth) / this->CellSize));
+            int r1 = std::min(rows - 1, (int)((sy + top + this->fontSize) / this->CellSize));
+
+            bool free = true;
+            for (int r = r0; r <= r1 && free; ++r)
+            {
+                for (int c = c0; c <= c1 && free; ++c)
+                    free = this->occupancy[(size_t)r * columns + c] == 0;
+            }
+            if (!free)
+                continue;
+            for (int r = r0; r <= r1; ++r)
+            {
+                for (int c = c0; c <= c1; ++c)
+                    this->occupancy[(size_t)r * columns + c] = 1;
+            }
+
+            GLfloat slot = (GLfloat)this->visible.size();
+            this->visible.push_back(index);
+            float pen = this->Offset.x;
+            for (char c : label.text)
+            {
+                const Glyph& glyph = this->GlyphFor(c);
+                if (glyph.x1 > glyph.x0)
+                {
+                    this->instances.push_back({ { pen + glyph.x0, top + glyph.y0, glyph.x1 - glyph.x0, glyph.y1 - glyph.y0 },
+                                                { glyph.u0, glyph.v0, glyph.u1, glyph.v1 },
+                                                { label.color.x, label.color.y, label.color.z, label.color.w },
+                                                slot });
+                }
+                pen += glyph.advance;
+            }
+        }
+
+        this->instanceCount = this->instances.size();
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, this->instances.size() * sizeof(GlyphInstance), this->instances.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        Metrics::Instance().Add(METRIC_UPLOAD_BYTES, this->instances.size() * sizeof(GlyphInstance));
+    }
+};
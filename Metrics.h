@@ -0,0 +1,473 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Socket Includes
+#ifdef _WIN32
+// Keep <windows.h> (pulled in by winsock2) from defining min/max macros over std::min/std::max and
+// from dragging in the rest of the Win32 API
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+typedef SOCKET metrics_socket;
+const metrics_socket METRICS_INVALID_SOCKET = INVALID_SOCKET;
+inline void metrics_close_socket(metrics_socket s) { closesocket(s); }
+inline void metrics_set_timeouts(metrics_socket s, int milliseconds)
+{
+    DWORD timeout = (DWORD)milliseconds;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+const int METRICS_SEND_FLAGS = 0;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int metrics_socket;
+const metrics_socket METRICS_INVALID_SOCKET = -1;
+inline void metrics_close_socket(metrics_socket s) { close(s); }
+inline void metrics_set_timeouts(metrics_socket s, int milliseconds)
+{
+    timeval timeout = { milliseconds / 1000, (milliseconds % 1000) * 1000 };
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+#ifdef MSG_NOSIGNAL
+const int METRICS_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int METRICS_SEND_FLAGS = 0;
+#endif
+#endif
+
+// Process-wide instrumentation: monotonic counters, last-value gauges and latency histograms.
+//
+// Counters and histograms are recorded into a shard owned by the calling thread, so a hot path only pays for
+// a thread_local lookup and an uncontended relaxed store; nothing is locked. A shard goes back to a free list
+// when its thread exits and is reused (keeping its totals) by the next new thread. Readers sum all shards.
+// Gauges are single atomics. Snapshots are Prometheus text, served by MetricsServer or written by MetricsFile.
+
+enum MetricCounter
+{
+    METRIC_PROPAGATIONS,
+    METRIC_PROPAGATION_FAILURES,
+    METRIC_UPLOAD_BYTES,
+    METRIC_EPHEMERIS_CACHE_HITS,
+    METRIC_EPHEMERIS_CACHE_MISSES,
+    METRIC_FRAMES,
+    METRIC_COUNTER_COUNT
+};
+
+enum MetricGauge
+{
+    METRIC_CATALOG_OBJECTS,
+    METRIC_TLE_PARSE_ERRORS,
+    METRIC_WORKER_QUEUE_DEPTH,
+    METRIC_GAUGE_COUNT
+};
+
+enum MetricHistogram
+{
+    METRIC_FRAME_SCENE,
+    METRIC_FRAME_UI,
+    METRIC_PASS_PROPAGATION,
+    METRIC_PASS_SATELLITES,
+    METRIC_PASS_TRAILS,
+    METRIC_PASS_LABELS,
+    METRIC_PASS_IMGUI,
+    METRIC_HISTOGRAM_COUNT
+};
+
+const char* const METRIC_COUNTER_NAMES[METRIC_COUNTER_COUNT][2] = {
+    { "satellite_propagations_total", "SGP4 propagations" },
+    { "satellite_propagation_failures_total", "Propagations that threw (decayed or invalid elements)" },
+    { "satellite_upload_bytes_total", "Bytes written to GPU buffers" },
+    { "satellite_ephemeris_cache_hits_total", "Region queries answered from a cached sub-satellite index" },
+    { "satellite_ephemeris_cache_misses_total", "Region queries that had to build the sub-satellite index" },
+    { "satellite_frames_total", "Presented frames" },
+};
+
+const char* const METRIC_GAUGE_NAMES[METRIC_GAUGE_COUNT][2] = {
+    { "satellite_catalog_objects", "Objects in the most recently loaded catalog" },
+    { "satellite_tle_parse_errors", "Malformed TLE records in the most recently loaded catalog" },
+    { "satellite_worker_queue_depth", "Propagation chunks waiting for a worker" },
+};
+
+const char* const METRIC_HISTOGRAM_PASSES[METRIC_HISTOGRAM_COUNT] = {
+    "frame_scene", "frame_ui", "propagation", "satellites", "trails", "labels", "imgui"
+};
+
+// Histogram upper bounds, seconds; one more bucket collects everything above
+const double METRIC_BUCKETS[] = { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.0166, 0.0333, 0.05, 0.1, 0.25 };
+const size_t METRIC_BUCKET_COUNT = sizeof(METRIC_BUCKETS) / sizeof(METRIC_BUCKETS[0]) + 1;
+
+// Written only by the owning thread, read by anyone
+struct alignas(64) MetricsShard
+{
+    std::atomic<uint64_t> counters[METRIC_COUNTER_COUNT];
+    std::atomic<uint64_t> buckets[METRIC_HISTOGRAM_COUNT][METRIC_BUCKET_COUNT];
+    std::atomic<uint64_t> sumNanoseconds[METRIC_HISTOGRAM_COUNT];
+
+    MetricsShard()
+    {
+        for (std::atomic<uint64_t>& counter : this->counters)
+            counter.store(0);
+        for (auto& histogram : this->buckets)
+            for (std::atomic<uint64_t>& bucket : histogram)
+                bucket.store(0);
+        for (std::atomic<uint64_t>& sum : this->sumNanoseconds)
+            sum.store(0);
+    }
+
+    static void Bump(std::atomic<uint64_t>& value, uint64_t amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+};
+
+class Metrics
+{
+public:
+    static Metrics& Instance()
+    {
+        static Metrics instance;
+        return instance;
+    }
+
+    void Add(MetricCounter counter, uint64_t amount = 1)
+    {
+        MetricsShard::Bump(this->LocalShard().counters[counter], amount);
+    }
+
+    void Set(MetricGauge gauge, int64_t value)
+    {
+        this->gauges[gauge].store(value, std::memory_order_relaxed);
+    }
+
+    void Observe(MetricHistogram histogram, double seconds)
+    {
+        size_t bucket = 0;
+        while (bucket + 1 < METRIC_BUCKET_COUNT && seconds > METRIC_BUCKETS[bucket])
+            ++bucket;
+        MetricsShard& shard = this->LocalShard();
+        MetricsShard::Bump(shard.buckets[histogram][bucket], 1);
+        MetricsShard::Bump(shard.sumNanoseconds[histogram], (uint64_t)(seconds * 1.0e9));
+    }
+
+    uint64_t Counter(MetricCounter counter)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        uint64_t total = 0;
+        for (const std::unique_ptr<MetricsShard>& shard : this->shards)
+            total += shard->counters[counter].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    // Prometheus text exposition format 0.0.4
+    std::string Prometheus()
+    {
+        uint64_t counters[METRIC_COUNTER_COUNT] = {};
+        uint64_t buckets[METRIC_HISTOGRAM_COUNT][METRIC_BUCKET_COUNT] = {};
+        uint64_t sums[METRIC_HISTOGRAM_COUNT] = {};
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            for (const std::unique_ptr<MetricsShard>& shard : this->shards)
+            {
+                for (size_t c = 0; c < METRIC_COUNTER_COUNT; ++c)
+                    counters[c] += shard->counters[c].load(std::memory_order_relaxed);
+                for (size_t h = 0; h < METRIC_HISTOGRAM_COUNT; ++h)
+                {
+                    for (size_t b = 0; b < METRIC_BUCKET_COUNT; ++b)
+                        buckets[h][b] += shard->buckets[h][b].load(std::memory_order_relaxed);
+                    sums[h] += shard->sumNanoseconds[h].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::ostringstream out;
+        for (size_t c = 0; c < METRIC_COUNTER_COUNT; ++c)
+        {
+            out << "# HELP " << METRIC_COUNTER_NAMES[c][0] << " " << METRIC_COUNTER_NAMES[c][1] << "\n";
+            out << "# TYPE " << METRIC_COUNTER_NAMES[c][0] << " counter\n";
+            out << METRIC_COUNTER_NAMES[c][0] << " " << counters[c] << "\n";
+        }
+        for (size_t g = 0; g < METRIC_GAUGE_COUNT; ++g)
+        {
+            out << "# HELP " << METRIC_GAUGE_NAMES[g][0] << " " << METRIC_GAUGE_NAMES[g][1] << "\n";
+            out << "# TYPE " << METRIC_GAUGE_NAMES[g][0] << " gauge\n";
+            out << METRIC_GAUGE_NAMES[g][0] << " " << this->gauges[g].load(std::memory_order_relaxed) << "\n";
+        }
+        out << "# HELP satellite_pass_seconds CPU time per frame and per render pass\n";
+        out << "# TYPE satellite_pass_seconds histogram\n";
+        for (size_t h = 0; h < METRIC_HISTOGRAM_COUNT; ++h)
+        {
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < METRIC_BUCKET_COUNT; ++b)
+            {
+                cumulative += buckets[h][b];
+                out << "satellite_pass_seconds_bucket{pass=\"" << METRIC_HISTOGRAM_PASSES[h] << "\",le=\"";
+                if (b + 1 < METRIC_BUCKET_COUNT)
+                    out << METRIC_BUCKETS[b];
+                else
+                    out << "+Inf";
+                out << "\"} " << cumulative << "\n";
+            }
+            out << "satellite_pass_seconds_sum{pass=\"" << METRIC_HISTOGRAM_PASSES[h] << "\"} " << sums[h] / 1.0e9 << "\n";
+            out << "satellite_pass_seconds_count{pass=\"" << METRIC_HISTOGRAM_PASSES[h] << "\"} " << cumulative << "\n";
+        }
+        return out.str();
+    }
+
+private:
+    std::mutex mutex;   // guards shard registration only
+    std::vector<std::unique_ptr<MetricsShard>> shards;
+    std::vector<MetricsShard*> freeShards;
+    std::atomic<int64_t> gauges[METRIC_GAUGE_COUNT];
+
+    Metrics()
+    {
+        for (std::atomic<int64_t>& gauge : this->gauges)
+            gauge.store(0);
+    }
+
+    // Holds the calling thread's shard and hands it back when the thread exits
+    struct Lease
+    {
+        Metrics& owner;
+        MetricsShard* shard;
+
+        explicit Lease(Metrics& owner) : owner(owner), shard(owner.Acquire()) {}
+        ~Lease() { this->owner.ReleaseShard(this->shard); }
+    };
+
+    MetricsShard& LocalShard()
+    {
+        thread_local Lease lease(*this);
+        return *lease.shard;
+    }
+
+    MetricsShard* Acquire()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->freeShards.empty())
+        {
+            MetricsShard* shard = this->freeShards.back();
+            this->freeShards.pop_back();
+            return shard;
+        }
+        this->shards.push_back(std::unique_ptr<MetricsShard>(new MetricsShard()));
+        return this->shards.back().get();
+    }
+
+    void ReleaseShard(MetricsShard* shard)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->freeShards.push_back(shard);
+    }
+};
+
+// Measures consecutive sections of one thread: each Lap records the time since the previous one
+class MetricTimer
+{
+public:
+    MetricTimer() : start(std::chrono::steady_clock::now()) {}
+
+    void Restart() { this->start = std::chrono::steady_clock::now(); }
+
+    void Lap(MetricHistogram histogram)
+    {
+        auto now = std::chrono::steady_clock::now();
+        Metrics::Instance().Observe(histogram, std::chrono::duration<double>(now - this->start).count());
+        this->start = now;
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Serves the Prometheus text on http://127.0.0.1:<port>/metrics from a background thread
+class MetricsServer
+{
+public:
+    MetricsServer() : running(false), listener(METRICS_INVALID_SOCKET) {}
+    ~MetricsServer() { this->Stop(); }
+
+    bool Start(int port)
+    {
+#ifdef _WIN32
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+        {
+            std::cout << "ERROR::METRICS::WINSOCK_NOT_INITIALIZED" << std::endl;
+            return false;
+        }
+#endif
+        this->listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        int reuse = 1;
+        setsockopt(this->listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons((unsigned short)port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (this->listener == METRICS_INVALID_SOCKET || bind(this->listener, (sockaddr*)&address, sizeof(address)) != 0 ||
+            listen(this->listener, 8) != 0)
+        {
+            std::cout << "ERROR::METRICS::PORT_NOT_AVAILABLE: " << port << std::endl;
+            if (this->listener != METRICS_INVALID_SOCKET)
+                metrics_close_socket(this->listener);
+            this->listener = METRICS_INVALID_SOCKET;
+            return false;
+        }
+        this->running = true;
+        this->thread = std::thread(&MetricsServer::Serve, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        if (!this->running)
+            return;
+        this->running = false;
+        this->thread.join();
+        metrics_close_socket(this->listener);
+        this->listener = METRICS_INVALID_SOCKET;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+
+private:
+    std::atomic<bool> running;
+    metrics_socket listener;
+    std::thread thread;
+
+    void Serve()
+    {
+        while (this->running)
+        {
+            // Wake up regularly so Stop() doesn't have to wait for a client
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(this->listener, &readable);
+            timeval timeout = { 0, 200000 };
+            if (select((int)this->listener + 1, &readable, NULL, NULL, &timeout) <= 0)
+                continue;
+            metrics_socket client = accept(this->listener, NULL, NULL);
+            if (client == METRICS_INVALID_SOCKET)
+                continue;
+            // A client that connects and then goes quiet (port scanner, half-open scrape) must not
+            // hold the thread, or Stop() would hang in join()
+            metrics_set_timeouts(client, 1000);
+            char request[1024];
+            int received = recv(client, request, sizeof(request) - 1, 0);
+            if (received <= 0)
+            {
+                metrics_close_socket(client);
+                continue;
+            }
+            request[received] = '\0';
+            std::string line(request);
+            bool found = line.compare(0, 13, "GET /metrics ") == 0 || line.compare(0, 6, "GET / ") == 0;
+            std::string body = found ? Metrics::Instance().Prometheus() : "not found\n";
+            std::ostringstream response;
+            response << "HTTP/1.0 " << (found ? "200 OK" : "404 Not Found") << "\r\n"
+                     << "Content-Type: text/plain; version=0.0.4\r\n"
+                     << "Content-Length: " << body.size() << "\r\n"
+                     << "Connection: close\r\n\r\n"
+                     << body;
+            std::string text = response.str();
+            for (size_t sent = 0; sent < text.size();)
+            {
+                int n = send(client, text.data() + sent, (int)(text.size() - sent), METRICS_SEND_FLAGS);
+                if (n <= 0)
+                    break;
+                sent += n;
+            }
+            metrics_close_socket(client);
+        }
+    }
+};
+
+// Rewrites a file with the Prometheus text every `interval` seconds and once more on Stop, for hosts
+// that scrape files (node_exporter textfile collector) or for headless runs
+class MetricsFile
+{
+public:
+    MetricsFile() : running(false), interval(10.0) {}
+    ~MetricsFile() { this->Stop(); }
+
+    void Start(const std::string& path, double intervalSeconds)
+    {
+        this->path = path;
+        this->interval = intervalSeconds;
+        this->running = true;
+        this->thread = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            while (this->running)
+            {
+                this->wake.wait_for(lock, std::chrono::duration<double>(this->interval));
+                this->Write();
+            }
+        });
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->running)
+                return;
+            this->running = false;
+        }
+        this->wake.notify_all();
+        this->thread.join();
+    }
+
+private:
+    std::string path;
+    bool running;
+    double interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread thread;
+
+    // Written next to the target and renamed, so readers never see a half-written file
+    void Write()
+    {
+        std::string temporary = this->path + ".tmp";
+        {
+            std::ofstream file(temporary);
+            if (!file.is_open())
+            {
+                std::cout << "ERROR::METRICS::FILE_NOT_SUCCESFULLY_WRITTEN: " << this->path << std::endl;
+                return;
+            }
+            file << Metrics::Instance().Prometheus();
+        }
+        std::remove(this->path.c_str());
+        std::rename(temporary.c_str(), this->path.c_str());
+    }
+};
@@ -0,0 +1,333 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <glm/glm/glm.hpp>
+
+#include "OrbitMath.h"
+#include "Catalog.h"
+
+// Ground station with its ECEF position and local east/north/up basis precomputed
+struct GroundStation
+{
+    std::string name;
+    double latitude;    // degrees
+    double longitude;   // degrees
+    double altitude;    // km
+    glm::dvec3 ecef;
+    glm::dvec3 east, north, up;
+
+    GroundStation(const std::string& name, double latitude, double longitude, double altitude)
+        : name(name), latitude(latitude), longitude(longitude), altitude(altitude)
+    {
+        double lat = latitude * PI / 180.0;
+        double lon = longitude * PI / 180.0;
+        this->ecef = geodetic_to_ecef(latitude, longitude, altitude);
+        this->east = glm::dvec3(-sin(lon), cos(lon), 0.0);
+        this->north = glm::dvec3(-sin(lat) * cos(lon), -sin(lat) * sin(lon), cos(lat));
+        this->up = glm::dvec3(cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat));
+    }
+};
+
+// Reads "name latitude longitude altitude_km" lines; '#' starts a comment
+inline std::vector<GroundStation> load_ground_stations(const std::string& path)
+{
+    std::vector<GroundStation> stations;
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        std::cout << "ERROR::OBSERVER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return stations;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name;
+        double latitude, longitude, altitude;
+        if (fields >> name >> latitude >> longitude >> altitude)
+            stations.emplace_back(name, latitude, longitude, altitude);
+        else
+            std::cout << "ERROR::OBSERVER::BAD_STATION_LINE: " << line << std::endl;
+    }
+    return stations;
+}
+
+// Earth-fixed states of many satellites at one instant, structure-of-arrays (km, km/s)
+struct StateArrays
+{
+    std::vector<double> x, y, z, vx, vy, vz;
+
+    void resize(size_t n)
+    {
+        x.resize(n); y.resize(n); z.resize(n);
+        vx.resize(n); vy.resize(n); vz.resize(n);
+    }
+    size_t size() const { return x.size(); }
+};
+
+// Observer geometry of many satellites from one station, structure-of-arrays
+struct ObserverArrays
+{
+    std::vector<float> range;       // km
+    std::vector<float> rangeRate;   // km/s, positive when receding
+    std::vector<float> azimuth;     // degrees from north, clockwise
+    std::vector<float> elevation;   // degrees
+    std::vector<float> doppler;     // Hz
+
+    void resize(size_t n)
+    {
+        range.resize(n); rangeRate.resize(n); azimuth.resize(n);
+        elevation.resize(n); doppler.resize(n);
+    }
+};
+
+// Range, range-rate, azimuth/elevation and Doppler shift of satellites [begin, end) seen from one station.
+// The loop is branch-free over plain arrays so the compiler can vectorise it; the station is fixed in
+// ECEF, so the satellite's Earth-fixed velocity is the relative velocity.
+inline void compute_observer_geometry(const StateArrays& states, size_t begin, size_t end, const GroundStation& station,
+                                      double carrierHz, ObserverArrays& out)
+{
+    const double* __restrict px = states.x.data();
+    const double* __restrict py = states.y.data();
+    const double* __restrict pz = states.z.data();
+    const double* __restrict vx = states.vx.data();
+    const double* __restrict vy = states.vy.data();
+    const double* __restrict vz = states.vz.data();
+    float* __restrict range = out.range.data();
+    float* __restrict rangeRate = out.rangeRate.data();
+    float* __restrict azimuth = out.azimuth.data();
+    float* __restrict elevation = out.elevation.data();
+    float* __restrict doppler = out.doppler.data();
+
+    const double sx = station.ecef.x, sy = station.ecef.y, sz = station.ecef.z;
+    const double ex = station.east.x, ey = station.east.y;
+    const double nx = station.north.x, ny = station.north.y, nz = station.north.z;
+    const double ux = station.up.x, uy = station.up.y, uz = station.up.z;
+    const double dopplerScale = -carrierHz / SPEED_OF_LIGHT_KM_S;
+    const double toDegrees = 180.0 / PI;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        double dx = px[i] - sx, dy = py[i] - sy, dz = pz[i] - sz;
+        double r = std::sqrt(dx * dx + dy * dy + dz * dz);
+        double rr = (dx * vx[i] + dy * vy[i] + dz * vz[i]) / r;
+        double e = dx * ex + dy * ey;
+        double n = dx * nx + dy * ny + dz * nz;
+        double u = dx * ux + dy * uy + dz * uz;
+        double az = std::atan2(e, n) * toDegrees;
+        range[i] = (float)r;
+        rangeRate[i] = (float)rr;
+        azimuth[i] = (float)(az < 0.0 ? az + 360.0 : az);
+        elevation[i] = (float)(std::asin(u / r) * toDegrees);
+        doppler[i] = (float)(rr * dopplerScale);
+    }
+}
+
+// Receives one time step of results: geometry[s] holds every satellite as seen from station s
+class ObserverSink
+{
+public:
+    virtual ~ObserverSink() {}
+    virtual void Write(double days, const Catalog& catalog, const std::vector<GroundStation>& stations,
+                       const std::vector<ObserverArrays>& geometry) = 0;
+};
+
+// Row per station/satellite pair above the elevation mask
+class ObserverCsvWriter : public ObserverSink
+{
+public:
+    ObserverCsvWriter(const std::string& path, float minElevation) : file(path), minElevation(minElevation)
+    {
+        if (!this->file.is_open())
+            std::cout << "ERROR::OBSERVER::FILE_NOT_SUCCESFULLY_OPENED: " << path << std::endl;
+        this->file << "days,station,norad,range_km,range_rate_km_s,azimuth_deg,elevation_deg,doppler_hz\n";
+        this->file.precision(10);
+    }
+
+    void Write(double days, const Catalog& catalog, const std::vector<GroundStation>& stations,
+               const std::vector<ObserverArrays>& geometry) override
+    {
+        for (size_t s = 0; s < stations.size(); ++s)
+        {
+            const ObserverArrays& g = geometry[s];
+            for (size_t i = 0; i < catalog.Size(); ++i)
+            {
+                if (g.elevation[i] < this->minElevation)
+                    continue;
+                this->file << days << "," << stations[s].name << "," << catalog.NoradNumberAt(i) << "," << g.range[i] << ","
+                           << g.rangeRate[i] << "," << g.azimuth[i] << "," << g.elevation[i] << "," << g.doppler[i] << "\n";
+            }
+        }
+    }
+
+private:
+    std::ofstream file;
+    float minElevation;
+};
+
+// Binary stream of packed records, same spirit as TrackPropagator's ephemeris files
+struct ObserverRecord
+{
+    double days;
+    uint32_t station;
+    uint32_t norad;
+    float range, rangeRate, azimuth, elevation, doppler;
+};
+
+class ObserverBinaryWriter : public ObserverSink
+{
+public:
+    ObserverBinaryWriter(const std::string& path, float minElevation) : file(path, std::ios::binary), minElevation(minElevation)
+    {
+        if (!this->file.is_open())
+            std::cout << "ERROR::OBSERVER::FILE_NOT_SUCCESFULLY_OPENED: " << path << std::endl;
+    }
+
+    void Write(double days, const Catalog& catalog, const std::vector<GroundStation>& stations,
+               const std::vector<ObserverArrays>& geometry) override
+    {
+        this->records.clear();
+        for (size_t s = 0; s < stations.size(); ++s)
+        {
+            const ObserverArrays& g = geometry[s];
+            for (size_t i = 0; i < catalog.Size(); ++i)
+            {
+                if (g.elevation[i] >= this->minElevation)
+                    this->records.push_back({ days, (uint32_t)s, catalog.NoradNumberAt(i), g.range[i], g.rangeRate[i], g.azimuth[i],
+                                              g.elevation[i], g.doppler[i] });
+            }
+        }
+        this->file.write(reinterpret_cast<const char*>(this->records.data()), this->records.size() * sizeof(ObserverRecord));
+    }
+
+private:
+    std::ofstream file;
+    float minElevation;
+    std::vector<ObserverRecord> records;
+};
+
+// Station x satellite x time grid. Each time step is propagated once for the whole catalog and
+// shared by all stations. Steps are processed a window at a time and handed to the sink in order;
+// inside a window the catalog is split into object chunks across the worker threads, so no SGP4
+// instance (deep-space ones keep integrator state between calls) is ever used by two threads.
+class ObserverGrid
+{
+public:
+    ObserverGrid(unsigned threads = 0) : threadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    // Returns the number of station/satellite/time cells computed
+    size_t Run(const Catalog& catalog, const std::vector<GroundStation>& stations, double startDays, double stepSeconds, size_t steps,
+               double carrierHz, ObserverSink& sink) const
+    {
+        size_t n = catalog.Size();
+        size_t window = std::min<size_t>(steps, this->threadCount * 2);
+        std::vector<StateArrays> states(window);
+        std::vector<std::vector<ObserverArrays>> geometry(window, std::vector<ObserverArrays>(stations.size()));
+        for (size_t w = 0; w < window; ++w)
+        {
+            states[w].resize(n);
+            for (ObserverArrays& g : geometry[w])
+                g.resize(n);
+        }
+
+        size_t chunks = (n + OBJECT_CHUNK - 1) / OBJECT_CHUNK;
+        for (size_t first = 0; first < steps; first += window)
+        {
+            size_t count = std::min(window, steps - first);
+            std::atomic<size_t> next(0);
+            auto worker = [&]() {
+                for (size_t chunk = next++; chunk < chunks; chunk = next++)
+                {
+                    size_t begin = chunk * OBJECT_CHUNK;
+                    size_t end = std::min(begin + OBJECT_CHUNK, n);
+                    for (size_t w = 0; w < count; ++w)
+                    {
+                        double days = startDays + (first + w) * stepSeconds / 86400.0;
+                        Propagate(catalog, days, begin, end, states[w]);
+                        for (size_t s = 0; s < stations.size(); ++s)
+                            compute_observer_geometry(states[w], begin, end, stations[s], carrierHz, geometry[w][s]);
+                    }
+                }
+            };
+            std::vector<std::thread> pool;
+            for (unsigned t = 1; t < std::min<size_t>(this->threadCount, chunks); ++t)
+                pool.emplace_back(worker);
+            worker();
+            for (std::thread& thread : pool)
+                thread.join();
+
+            for (size_t w = 0; w < count; ++w)
+                sink.Write(startDays + (first + w) * stepSeconds / 86400.0, catalog, stations, geometry[w]);
+        }
+        return steps * stations.size() * n;
+    }
+
+    // Earth-fixed states of objects [begin, end) at one instant, written at their catalog index.
+    // Objects that fail to propagate are parked at the Earth's centre, which puts them below every mask.
+    static void Propagate(const Catalog& catalog, double days, size_t begin, size_t end, StateArrays& states)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            glm::dvec3 position(0.0), velocity(0.0);
+            try
+            {
+                eci_to_ecef_km(catalog.FindPosition(i, days), days, position, velocity);
+            }
+            catch (const std::exception&)
+            {
+            }
+            states.x[i] = position.x; states.y[i] = position.y; states.z[i] = position.z;
+            states.vx[i] = velocity.x; states.vy[i] = velocity.y; states.vz[i] = velocity.z;
+        }
+    }
+
+private:
+    // Objects per work item
+    static const size_t OBJECT_CHUNK = 256;
+
+    unsigned threadCount;
+};
+
+// Headless entry point: writes range/range-rate/az-el/Doppler of every catalog object above the
+// horizon of every station. The grid starts at the newest epoch in the catalog.
+inline int run_observer_grid(const std::string& catalogPath, const std::string& stationsPath, double carrierMHz, double hours,
+                             double stepSeconds, const std::string& outputPath)
+{
+    Catalog catalog;
+    std::vector<GroundStation> stations = load_ground_stations(stationsPath);
+    if (!catalog.LoadFromFile(catalogPath) || catalog.Size() == 0 || stations.empty() || stepSeconds <= 0.0)
+        return 2;
+    double startDays = 0.0;
+    for (size_t i = 0; i < catalog.Size(); ++i)
+        startDays = std::max(startDays, catalog.EpochDaysAt(i));
+    size_t steps = (size_t)(hours * 3600.0 / stepSeconds) + 1;
+
+    std::unique_ptr<ObserverSink> sink;
+    if (outputPath.size() > 4 && outputPath.compare(outputPath.size() - 4, 4, ".bin") == 0)
+        sink.reset(new ObserverBinaryWriter(outputPath, 0.0f));
+    else
+        sink.reset(new ObserverCsvWriter(outputPath, 0.0f));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t cells = ObserverGrid().Run(catalog, stations, startDays, stepSeconds, steps, carrierMHz * 1.0e6, *sink);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << cells << " station/satellite/time cells in " << seconds << " s" << std::endl;
+    return 0;
+}
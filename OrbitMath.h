@@ -0,0 +1,164 @@
+#pragma once
+
+// Std. Includes
+#include <string>
+#include <stdexcept>
+#include <cmath>
+#include <iostream>
+
+// GL Includes
+#include <glm/glm/glm.hpp>
+
+// SGP4 Includes
+#include <SGP4.h>
+
+#define PI 3.1415926535
+
+const double EARTH_RADIUS_KM = 6371.0;
+
+// Greenwich mean sidereal time (radians) for D days since 2000-01-01 00:00 UT.
+// The Earth-rotation-angle formula counts from J2000.0 (2000-01-01 12:00 UT), hence the half-day shift.
+inline double gmst(double D) {
+    D -= 0.5;
+    double T = D / 36525;
+    double GMST = 2*PI*(0.7790572732640 + 1.00273781191135448*D+(T*T)/(36525*365225)*(0.093104 - 0.0000062*T));
+    return GMST;
+}
+
+// Converts a TLE epoch string ("YYDDD.DDDDDDDD") to days since 2000-01-01
+inline double calculate_days(const std::string& tle_epoch) {
+    size_t dot_pos = tle_epoch.find('.');
+    std::string integer_part;
+    std::string fractional_part = "0";
+
+    if (dot_pos != std::string::npos) {
+        integer_part = tle_epoch.substr(0, dot_pos);
+        fractional_part = tle_epoch.substr(dot_pos + 1);
+    }
+    else {
+        integer_part = tle_epoch;
+    }
+
+    if (integer_part.size() != 5) {
+        throw std::invalid_argument("Invalid TLE epoch format");
+    }
+
+    int yy = stoi(integer_part.substr(0, 2));
+    int ddd = stoi(integer_part.substr(2, 3));
+    int Y = 2000 + yy;
+
+    bool is_leap = (Y % 4 == 0 && Y % 100 != 0) || (Y % 400 == 0);
+    int max_days = is_leap ? 366 : 365;
+    if (ddd < 1 || ddd > max_days) {
+        throw std::invalid_argument("Invalid day of year");
+    }
+
+    int years_count = Y - 2000;
+    int leap_count = 0;
+    for (int y = 2000; y < Y; ++y) {
+        if ((y % 4 == 0 && y % 100 != 0) || (y % 400 == 0)) {
+            leap_count++;
+        }
+    }
+
+    double days_before = years_count * 365 + leap_count + (ddd - 1);
+
+    double fractional = 0.0;
+    if (!fractional_part.empty()) {
+        fractional = stod("0." + fractional_part);
+    }
+    return days_before + fractional;
+}
+
+// Epoch field of TLE line 1 (columns 19-32) in days since 2000-01-01
+inline double tle_line1_epoch_days(const std::string& line1) {
+    std::string epoch = line1.substr(18, 14);
+    size_t first = epoch.find_first_not_of(' ');
+    size_t last = epoch.find_last_not_of(' ');
+    if (first == std::string::npos) {
+        throw std::invalid_argument("Invalid TLE epoch format");
+    }
+    return calculate_days(epoch.substr(first, last - first + 1));
+}
+
+inline glm::vec3 toGLMCoordinates(const glm::vec3& ecef) {
+    return glm::vec3(
+        ecef.x / EARTH_RADIUS_KM,
+        ecef.y / EARTH_RADIUS_KM,
+        ecef.z / EARTH_RADIUS_KM
+    );
+}
+
+// Rotates an SGP4 state into the scene's Earth-fixed frame (Earth radii) at the given day.
+// Builds before gmst() took the J2000-noon shift were off by pi + 0.0086 rad and negated x/y, which
+// cancels only the pi: their scene sat 0.49 degrees west of true Earth-fixed. Positions are now
+// 0.49 degrees further east, so sessions recorded with those builds replay slightly rotated.
+inline glm::vec3 eci_to_scene(const libsgp4::Eci& eci, double days) {
+    double gmst_rad = gmst(days);
+    double cos_g = cos(gmst_rad);
+    double sin_g = sin(gmst_rad);
+    glm::dmat3 rotation_matrix{
+        cos_g,  sin_g, 0.0,
+        -sin_g, cos_g, 0.0,
+        0.0,    0.0,   1.0
+    };
+    glm::dvec3 eci_pos(eci.Position().x, eci.Position().y, eci.Position().z);
+    return toGLMCoordinates(glm::vec3(eci_pos * rotation_matrix));
+}
+
+const double EARTH_ROTATION_RAD_S = 7.292115146706979e-5;
+const double WGS84_A_KM = 6378.137;
+const double WGS84_F = 1.0 / 298.257223563;
+const double SPEED_OF_LIGHT_KM_S = 299792.458;
+
+// Earth-fixed state in km and km/s (GMST rotation only, no polar motion); eci_to_scene is the same rotation in Earth radii
+inline void eci_to_ecef_km(const libsgp4::Eci& eci, double days, glm::dvec3& position, glm::dvec3& velocity) {
+    double gmst_rad = gmst(days);
+    double cos_g = cos(gmst_rad);
+    double sin_g = sin(gmst_rad);
+    libsgp4::Vector p = eci.Position();
+    libsgp4::Vector v = eci.Velocity();
+    position = glm::dvec3(cos_g * p.x + sin_g * p.y, -sin_g * p.x + cos_g * p.y, p.z);
+    // v_ecef = R v_eci - w x r_ecef
+    velocity = glm::dvec3(cos_g * v.x + sin_g * v.y + EARTH_ROTATION_RAD_S * position.y,
+                          -sin_g * v.x + cos_g * v.y - EARTH_ROTATION_RAD_S * position.x,
+                          v.z);
+}
+
+// Inverse of eci_to_ecef_km
+inline void ecef_to_eci_km(const glm::dvec3& position, const glm::dvec3& velocity, double days, glm::dvec3& eciPosition, glm::dvec3& eciVelocity) {
+    double gmst_rad = gmst(days);
+    double cos_g = cos(gmst_rad);
+    double sin_g = sin(gmst_rad);
+    // R v_eci = v_ecef + w x r_ecef
+    double vx = velocity.x - EARTH_ROTATION_RAD_S * position.y;
+    double vy = velocity.y + EARTH_ROTATION_RAD_S * position.x;
+    eciPosition = glm::dvec3(cos_g * position.x - sin_g * position.y, sin_g * position.x + cos_g * position.y, position.z);
+    eciVelocity = glm::dvec3(cos_g * vx - sin_g * vy, sin_g * vx + cos_g * vy, velocity.z);
+}
+
+// WGS-84 geodetic latitude/longitude (degrees) and altitude (km) to ECEF km
+inline glm::dvec3 geodetic_to_ecef(double latitudeDeg, double longitudeDeg, double altitudeKm) {
+    double lat = latitudeDeg * PI / 180.0;
+    double lon = longitudeDeg * PI / 180.0;
+    double e2 = WGS84_F * (2.0 - WGS84_F);
+    double n = WGS84_A_KM / sqrt(1.0 - e2 * sin(lat) * sin(lat));
+    return glm::dvec3((n + altitudeKm) * cos(lat) * cos(lon),
+                      (n + altitudeKm) * cos(lat) * sin(lon),
+                      (n * (1.0 - e2) + altitudeKm) * sin(lat));
+}
+
+// Known sidereal angles, degrees: J2000.0 itself, and 2024-01-01 00:00 UT (6h40m30.6s; the
+// rotation-angle formula leaves out precession, about 0.3 degrees by then)
+inline bool check_earth_rotation() {
+    const double checks[2][3] = { { 0.5, 280.46061837, 1e-6 }, { 8766.0, 100.1275, 0.5 } };
+    for (const auto& check : checks) {
+        double degrees = fmod(gmst(check[0]) * 180.0 / PI, 360.0);
+        double error = fabs(remainder(degrees - check[1], 360.0));
+        if (error > check[2]) {
+            std::cout << "ERROR::ORBIT_MATH::GMST_MISMATCH at day " << check[0] << ": " << degrees << " instead of " << check[1] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
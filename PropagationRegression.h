@@ -0,0 +1,408 @@
+#pragma once
+
+// Std. Includes
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// SGP4 Includes
+#include <Tle.h>
+#include <SGP4.h>
+
+#include "Catalog.h"
+#include "TrackPropagator.h"
+#include "RegionQuery.h"
+#include "ObserverGeometry.h"
+
+// Accuracy-vs-speed regression of every fast propagation path against plain SGP4::FindPosition
+// with a freshly constructed Tle/SGP4 per sample (what calculate_iss_position_ecef does).
+
+// Time grid relative to each object's own epoch
+struct RegressionGrid
+{
+    std::string name;
+    double startOffsetDays;
+    double stepSeconds;
+    size_t count;
+};
+
+// A propagation path fills out[0..count) for catalog object `index` and returns the number of valid samples
+typedef std::function<size_t(const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                             EphemerisRecord* out)> PropagationPathFn;
+
+struct PropagationPath
+{
+    std::string name;
+    PropagationPathFn run;
+    double maxPositionErrorKm;
+    double maxVelocityErrorKmS;
+    // The path yields positions only; velocities are neither compared nor reported
+    bool positionsOnly = false;
+};
+
+struct RegressionResult
+{
+    std::string path;
+    std::string grid;
+    size_t samples;
+    double maxPositionErrorKm;
+    double rmsPositionErrorKm;
+    double maxVelocityErrorKmS;
+    double rmsVelocityErrorKmS;
+    double samplesPerSecond;
+    bool passed;
+    std::string failure;
+};
+
+class PropagationRegression
+{
+public:
+    // Allowed throughput drop against a baseline run before the suite fails (0.2 = 20 % slower)
+    double throughputTolerance;
+
+    PropagationRegression() : throughputTolerance(0.2)
+    {
+        this->grids.push_back({ "1 orbit @ 1 s", 0.0, 1.0, 6000 });
+        this->grids.push_back({ "1 day @ 60 s", 0.0, 60.0, 1440 });
+        this->grids.push_back({ "30 days @ 10 min", -15.0, 600.0, 4320 });
+
+        this->AddPath({ "cached", [](const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                                     EphemerisRecord* out) {
+            for (size_t i = 0; i < count; ++i)
+            {
+                double days = startDays + i * stepSeconds / 86400.0;
+                try
+                {
+                    libsgp4::Eci eci = catalog.FindPosition(index, days);
+                    out[i] = ToRecord(days, eci);
+                }
+                catch (const std::exception&)
+                {
+                    return i;
+                }
+            }
+            return count;
+        }, 1e-6, 1e-9 });
+
+        this->AddPath({ "track", [](const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                                    EphemerisRecord* out) {
+            TrackPropagator track(catalog.PropagatorAt(index), catalog.EpochDaysAt(index));
+            return track.PropagateStates(startDays, stepSeconds, count, out);
+        }, 1e-6, 1e-9 });
+
+        // Viewer positions: float Earth radii, so a few metres at GEO distance
+        this->AddPath({ "scene", [](const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                                    EphemerisRecord* out) {
+            for (size_t i = 0; i < count; ++i)
+            {
+                double days = startDays + i * stepSeconds / 86400.0;
+                glm::vec3 scene;
+                if (catalog.PropagateScene(days, index, index + 1, &scene) != 0)
+                    return i;
+                glm::dvec3 ecef(scene.x * EARTH_RADIUS_KM, scene.y * EARTH_RADIUS_KM, scene.z * EARTH_RADIUS_KM);
+                out[i] = FromEcef(days, ecef, glm::dvec3(0.0));
+            }
+            return count;
+        }, 1e-2, 0.0, true });
+
+        // Earth-fixed states fed to the observer-geometry kernel
+        this->AddPath({ "observer", [](const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                                       EphemerisRecord* out) {
+            StateArrays states;
+            states.resize(index + 1);
+            for (size_t i = 0; i < count; ++i)
+            {
+                double days = startDays + i * stepSeconds / 86400.0;
+                ObserverGrid::Propagate(catalog, days, index, index + 1, states);
+                if (states.x[index] == 0.0 && states.y[index] == 0.0 && states.z[index] == 0.0)
+                    return i;
+                out[i] = FromEcef(days, glm::dvec3(states.x[index], states.y[index], states.z[index]),
+                                  glm::dvec3(states.vx[index], states.vy[index], states.vz[index]));
+            }
+            return count;
+        }, 1e-6, 1e-9 });
+
+        // Geodetic latitude/longitude/altitude the region index and refinement work from
+        this->AddPath({ "region", [](const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count,
+                                     EphemerisRecord* out) {
+            for (size_t i = 0; i < count; ++i)
+            {
+                double days = startDays + i * stepSeconds / 86400.0;
+                double lat, lon, altitude;
+                if (!sub_satellite_point(catalog, index, days, lat, lon, altitude))
+                    return i;
+                out[i] = FromEcef(days, geodetic_to_ecef(lat, lon, altitude), glm::dvec3(0.0));
+            }
+            return count;
+        }, 1e-3, 0.0, true });
+    }
+
+    // Registers another path; later fast paths add themselves here with their own error bounds
+    void AddPath(const PropagationPath& path) { this->paths.push_back(path); }
+
+    void SetGrids(const std::vector<RegressionGrid>& newGrids) { this->grids = newGrids; }
+
+    // Runs every path over every grid. Reference and path throughput are both reported.
+    std::vector<RegressionResult> Run(const Catalog& catalog) const
+    {
+        std::vector<RegressionResult> results;
+        for (const RegressionGrid& grid : this->grids)
+        {
+            std::vector<std::vector<EphemerisRecord>> reference(catalog.Size());
+            std::vector<size_t> referenceValid(catalog.Size());
+            double elapsed = Measure([&]() {
+                for (size_t index = 0; index < catalog.Size(); ++index)
+                {
+                    reference[index].resize(grid.count);
+                    referenceValid[index] = Reference(catalog, index, StartDays(catalog, index, grid), grid.stepSeconds,
+                                                      grid.count, reference[index].data());
+                }
+            });
+            RegressionResult ref = { "reference", grid.name, 0, 0.0, 0.0, 0.0, 0.0, 0.0, true, "" };
+            for (size_t valid : referenceValid)
+                ref.samples += valid;
+            ref.samplesPerSecond = elapsed > 0.0 ? ref.samples / elapsed : 0.0;
+            results.push_back(ref);
+
+            std::vector<EphemerisRecord> samples(grid.count);
+            for (const PropagationPath& path : this->paths)
+            {
+                RegressionResult result = { path.name, grid.name, 0, 0.0, 0.0, 0.0, 0.0, 0.0, true, "" };
+                double sumPosition = 0.0, sumVelocity = 0.0, seconds = 0.0;
+                for (size_t index = 0; index < catalog.Size(); ++index)
+                {
+                    size_t valid = 0;
+                    seconds += Measure([&]() {
+                        valid = path.run(catalog, index, StartDays(catalog, index, grid), grid.stepSeconds, grid.count, samples.data());
+                    });
+                    if (valid != referenceValid[index])
+                    {
+                        result.passed = false;
+                        result.failure = "valid sample count differs for " + std::string(catalog.InfoAt(index).name);
+                    }
+                    size_t compared = std::min(valid, referenceValid[index]);
+                    for (size_t i = 0; i < compared; ++i)
+                    {
+                        const EphemerisRecord& a = samples[i];
+                        const EphemerisRecord& b = reference[index][i];
+                        double dp = std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+                        double dv = path.positionsOnly ? 0.0 : std::sqrt((a.vx - b.vx) * (a.vx - b.vx) + (a.vy - b.vy) * (a.vy - b.vy) +
+                                                                         (a.vz - b.vz) * (a.vz - b.vz));
+                        result.maxPositionErrorKm = std::max(result.maxPositionErrorKm, dp);
+                        result.maxVelocityErrorKmS = std::max(result.maxVelocityErrorKmS, dv);
+                        sumPosition += dp * dp;
+                        sumVelocity += dv * dv;
+                    }
+                    result.samples += compared;
+                }
+                if (result.samples > 0)
+                {
+                    result.rmsPositionErrorKm = std::sqrt(sumPosition / result.samples);
+                    result.rmsVelocityErrorKmS = std::sqrt(sumVelocity / result.samples);
+                }
+                result.samplesPerSecond = seconds > 0.0 ? result.samples / seconds : 0.0;
+                if (result.maxPositionErrorKm > path.maxPositionErrorKm)
+                    Fail(result, "position error above bound");
+                if (!path.positionsOnly && result.maxVelocityErrorKmS > path.maxVelocityErrorKmS)
+                    Fail(result, "velocity error above bound");
+                results.push_back(result);
+            }
+        }
+        return results;
+    }
+
+    // Marks results whose throughput fell more than throughputTolerance below a previous JSON report
+    void CompareWithBaseline(std::vector<RegressionResult>& results, const std::string& baselinePath) const
+    {
+        std::map<std::string, double> baseline = ReadThroughput(baselinePath);
+        for (RegressionResult& result : results)
+        {
+            auto it = baseline.find(result.path + "|" + result.grid);
+            if (it == baseline.end() || it->second <= 0.0)
+                continue;
+            if (result.samplesPerSecond < it->second * (1.0 - this->throughputTolerance))
+                Fail(result, "throughput regressed");
+        }
+    }
+
+    // One result object per line so reports diff and chart cleanly across releases
+    static void WriteJson(const std::vector<RegressionResult>& results, size_t objects, std::ostream& out)
+    {
+        out << "{\n  \"objects\": " << objects << ",\n  \"results\": [\n";
+        out << std::setprecision(9);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const RegressionResult& r = results[i];
+            out << "    {\"path\": \"" << JsonEscape(r.path) << "\", \"grid\": \"" << JsonEscape(r.grid) << "\", \"samples\": " << r.samples
+                << ", \"max_position_error_km\": " << r.maxPositionErrorKm << ", \"rms_position_error_km\": " << r.rmsPositionErrorKm
+                << ", \"max_velocity_error_km_s\": " << r.maxVelocityErrorKmS << ", \"rms_velocity_error_km_s\": " << r.rmsVelocityErrorKmS
+                << ", \"samples_per_sec\": " << r.samplesPerSecond << ", \"passed\": " << (r.passed ? "true" : "false")
+                << ", \"failure\": \"" << JsonEscape(r.failure) << "\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    static void PrintTable(const std::vector<RegressionResult>& results, std::ostream& out)
+    {
+        out << std::left << std::setw(12) << "path" << std::setw(20) << "grid" << std::right << std::setw(14) << "max dp, km"
+            << std::setw(14) << "rms dp, km" << std::setw(14) << "max dv, km/s" << std::setw(16) << "samples/s" << "  status" << std::endl;
+        for (const RegressionResult& r : results)
+        {
+            out << std::left << std::setw(12) << r.path << std::setw(20) << r.grid << std::right << std::scientific << std::setprecision(3)
+                << std::setw(14) << r.maxPositionErrorKm << std::setw(14) << r.rmsPositionErrorKm << std::setw(14) << r.maxVelocityErrorKmS
+                << std::setw(16) << r.samplesPerSecond << std::defaultfloat << "  " << (r.passed ? "ok" : "FAIL " + r.failure) << std::endl;
+        }
+    }
+
+private:
+    std::vector<RegressionGrid> grids;
+    std::vector<PropagationPath> paths;
+
+    static double StartDays(const Catalog& catalog, size_t index, const RegressionGrid& grid)
+    {
+        return catalog.EpochDaysAt(index) + grid.startOffsetDays;
+    }
+
+    static EphemerisRecord ToRecord(double days, const libsgp4::Eci& eci)
+    {
+        return { days, eci.Position().x, eci.Position().y, eci.Position().z, eci.Velocity().x, eci.Velocity().y, eci.Velocity().z };
+    }
+
+    // Earth-fixed paths are rotated back to the SGP4 frame for comparison
+    static EphemerisRecord FromEcef(double days, const glm::dvec3& position, const glm::dvec3& velocity)
+    {
+        glm::dvec3 p, v;
+        ecef_to_eci_km(position, velocity, days, p, v);
+        return { days, p.x, p.y, p.z, v.x, v.y, v.z };
+    }
+
+    static std::string JsonEscape(const std::string& text)
+    {
+        std::ostringstream escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped << '\\' << c;
+            else if ((unsigned char)c < 0x20)
+                escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+            else
+                escaped << c;
+        }
+        return escaped.str();
+    }
+
+    static size_t Reference(const Catalog& catalog, size_t index, double startDays, double stepSeconds, size_t count, EphemerisRecord* out)
+    {
+        const CatalogEntryInfo& info = catalog.InfoAt(index);
+        std::string name(info.name), line1(info.line1), line2(info.line2);
+        double epoch = catalog.EpochDaysAt(index);
+        for (size_t i = 0; i < count; ++i)
+        {
+            double days = startDays + i * stepSeconds / 86400.0;
+            try
+            {
+                libsgp4::Tle tle(name, line1, line2);
+                libsgp4::SGP4 sgp4(tle);
+                out[i] = ToRecord(days, sgp4.FindPosition((days - epoch) * 1440.0));
+            }
+            catch (const std::exception&)
+            {
+                return i;
+            }
+        }
+        return count;
+    }
+
+    template <typename Body>
+    static double Measure(Body body)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static void Fail(RegressionResult& result, const std::string& reason)
+    {
+        result.passed = false;
+        result.failure = result.failure.empty() ? reason : result.failure + "; " + reason;
+    }
+
+    // Reads "path|grid" -> samples_per_sec from a report written by WriteJson
+    static std::map<std::string, double> ReadThroughput(const std::string& path)
+    {
+        std::map<std::string, double> throughput;
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::REGRESSION::BASELINE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return throughput;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::string name = Field(line, "path"), grid = Field(line, "grid"), rate = Field(line, "samples_per_sec");
+            if (!name.empty() && !rate.empty())
+                throughput[name + "|" + grid] = std::stod(rate);
+        }
+        return throughput;
+    }
+
+    static std::string Field(const std::string& line, const std::string& key)
+    {
+        std::string marker = "\"" + key + "\": ";
+        size_t pos = line.find(marker);
+        if (pos == std::string::npos)
+            return "";
+        pos += marker.size();
+        if (line[pos] == '"')
+        {
+            // Undoes JsonEscape for quotes and backslashes, which is all the keys can contain
+            std::string value;
+            for (++pos; pos < line.size() && line[pos] != '"'; ++pos)
+                value += line[pos] == '\\' && pos + 1 < line.size() ? line[++pos] : line[pos];
+            return value;
+        }
+        return line.substr(pos, line.find_first_of(",}", pos) - pos);
+    }
+};
+
+// Headless entry point: loads the corpus, runs the suite, writes the JSON report.
+// Returns a process exit code (0 when every path is within its bounds).
+inline int run_propagation_regression(const std::string& corpusPath, const std::string& reportPath, const std::string& baselinePath)
+{
+    if (!check_earth_rotation())
+        return 1;
+    Catalog catalog;
+    if (!catalog.LoadFromFile(corpusPath) || catalog.Size() == 0)
+        return 2;
+    if (!check_region_query(catalog))
+        return 1;
+
+    PropagationRegression suite;
+    std::vector<RegressionResult> results = suite.Run(catalog);
+    if (!baselinePath.empty())
+        suite.CompareWithBaseline(results, baselinePath);
+
+    PropagationRegression::PrintTable(results, std::cout);
+    std::ofstream report(reportPath);
+    if (!report.is_open())
+    {
+        std::cout << "ERROR::REGRESSION::REPORT_NOT_SUCCESFULLY_OPENED: " << reportPath << std::endl;
+        return 2;
+    }
+    PropagationRegression::WriteJson(results, catalog.Size(), report);
+
+    for (const RegressionResult& result : results)
+    {
+        if (!result.passed)
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,521 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <glm/glm/glm.hpp>
+
+#include "OrbitMath.h"
+#include "Catalog.h"
+
+// Geographic area: a lat/lon box (lonMin > lonMax wraps across the antimeridian) or a lat/lon polygon
+struct GeoRegion
+{
+    double latMin, latMax;
+    double lonMin, lonMax;
+    std::vector<glm::dvec2> polygon;   // (lat, lon) vertices in degrees; empty for a plain box
+
+    static GeoRegion Box(double latMin, double latMax, double lonMin, double lonMax)
+    {
+        GeoRegion region;
+        region.latMin = latMin;
+        region.latMax = latMax;
+        region.lonMin = lonMin;
+        region.lonMax = lonMax;
+        return region;
+    }
+
+    // Polygon in (lat, lon) degrees; it must not cross the antimeridian
+    static GeoRegion Polygon(const std::vector<glm::dvec2>& vertices)
+    {
+        GeoRegion region = Box(90.0, -90.0, 180.0, -180.0);
+        region.polygon = vertices;
+        for (const glm::dvec2& v : vertices)
+        {
+            region.latMin = std::min(region.latMin, v.x);
+            region.latMax = std::max(region.latMax, v.x);
+            region.lonMin = std::min(region.lonMin, v.y);
+            region.lonMax = std::max(region.lonMax, v.y);
+        }
+        return region;
+    }
+
+    bool Contains(double lat, double lon) const
+    {
+        if (lat < this->latMin || lat > this->latMax)
+            return false;
+        bool inLon = this->lonMin <= this->lonMax ? (lon >= this->lonMin && lon <= this->lonMax)
+                                                  : (lon >= this->lonMin || lon <= this->lonMax);
+        if (!inLon || this->polygon.empty())
+            return inLon;
+        // Even-odd ray casting in the lat/lon plane
+        bool inside = false;
+        for (size_t i = 0, j = this->polygon.size() - 1; i < this->polygon.size(); j = i++)
+        {
+            const glm::dvec2& a = this->polygon[i];
+            const glm::dvec2& b = this->polygon[j];
+            if ((a.x > lat) != (b.x > lat) && lon < (b.y - a.y) * (lat - a.x) / (b.x - a.x) + a.y)
+                inside = !inside;
+        }
+        return inside;
+    }
+};
+
+// One visit of an object to a region; entry/exit are clamped to the query window
+struct RegionPass
+{
+    CatalogHandle handle;
+    uint32_t norad;
+    double entryDays;
+    double exitDays;
+};
+
+// Sub-satellite point (geodetic lat/lon, degrees) and altitude (km) of an object at a given day
+inline bool sub_satellite_point(const Catalog& catalog, size_t index, double days, double& lat, double& lon, double& altitudeKm)
+{
+    glm::dvec3 position, velocity;
+    try
+    {
+        eci_to_ecef_km(catalog.FindPosition(index, days), days, position, velocity);
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    double e2 = WGS84_F * (2.0 - WGS84_F);
+    lon = atan2(position.y, position.x) * 180.0 / PI;
+    double p = sqrt(position.x * position.x + position.y * position.y);
+    // The one-step latitude is only exact on the surface; a few fixed-point steps bring it to
+    // millimetres from LEO to beyond GEO
+    double phi = atan2(position.z, (1.0 - e2) * p);
+    for (int i = 0; i < 4; ++i)
+    {
+        double n = WGS84_A_KM / sqrt(1.0 - e2 * sin(phi) * sin(phi));
+        altitudeKm = p * cos(phi) + position.z * sin(phi) - WGS84_A_KM * sqrt(1.0 - e2 * sin(phi) * sin(phi));
+        phi = atan2(position.z, p * (1.0 - e2 * n / (n + altitudeKm)));
+    }
+    lat = phi * 180.0 / PI;
+    altitudeKm = p * cos(phi) + position.z * sin(phi) - WGS84_A_KM * sqrt(1.0 - e2 * sin(phi) * sin(phi));
+    return true;
+}
+
+// Latitude and altitude bounds of an orbit, from the mean elements on TLE line 2
+struct OrbitShell
+{
+    double maxLatitude;   // degrees
+    double perigeeKm;
+    double apogeeKm;
+    double meanMotion;    // revolutions per day
+
+    explicit OrbitShell(std::string_view line2)
+    {
+        std::string line(line2);
+        double inclination = std::stod(line.substr(8, 8));
+        double eccentricity = std::stod("0." + line.substr(26, 7));
+        this->meanMotion = std::stod(line.substr(52, 11));
+        this->maxLatitude = inclination <= 90.0 ? inclination : 180.0 - inclination;
+        // Semi-major axis from Kepler's third law, mu = 398600.4418 km^3/s^2
+        double n = this->meanMotion * 2.0 * PI / 86400.0;
+        double a = std::cbrt(398600.4418 / (n * n));
+        this->perigeeKm = a * (1.0 - eccentricity) - WGS84_A_KM;
+        this->apogeeKm = a * (1.0 + eccentricity) - WGS84_A_KM;
+    }
+};
+
+// "Which objects are over this area during this window".
+//
+// 1. Objects whose inclination or perigee/apogee rule them out are pruned without propagation.
+// 2. A coarse index holds, for every object and time bucket, the lat/lon grid cell under the object
+//    (2 bytes each). Buckets whose cell lies near the region are the (object, time bucket) candidates.
+//    The index is built lazily per time window and cached, so repeated queries over the same window
+//    skip propagation entirely at this stage.
+// 3. Candidates are refined with exact propagation and bisection for entry/exit times. A pass is a
+//    stretch where the sub-satellite point is inside the region and the altitude is within the band.
+class RegionQueryEngine
+{
+public:
+    // Coarse index resolution
+    double BucketSeconds;
+    double CellDegrees;
+    // Fine sampling step and entry/exit precision used when refining candidates
+    double RefineStepSeconds;
+    double TimeToleranceSeconds;
+    // Number of cached windows
+    size_t CacheSize;
+    // Widens the perigee/apogee prune in both directions. The shell is a(1 -+ e) above the equatorial
+    // radius, but the ellipsoid is ~21 km lower at the poles and osculating radii wander from the mean ones.
+    double ShellSlackKm;
+
+    explicit RegionQueryEngine(const Catalog& catalog)
+        : BucketSeconds(60.0), CellDegrees(5.0), RefineStepSeconds(10.0), TimeToleranceSeconds(0.5), CacheSize(4),
+          ShellSlackKm(30.0), catalog(catalog), hits(0), misses(0)
+    {
+        this->Invalidate();
+    }
+
+    // Must be called after the catalog is reloaded
+    void Invalidate()
+    {
+        this->indices.clear();
+        this->shells.clear();
+        this->shells.reserve(this->catalog.Size());
+        for (size_t i = 0; i < this->catalog.Size(); ++i)
+            this->shells.push_back(OrbitShell(this->catalog.InfoAt(i).line2));
+    }
+
+    std::vector<RegionPass> Query(const GeoRegion& region, double startDays, double endDays, double minAltitudeKm = 0.0,
+                                  double maxAltitudeKm = std::numeric_limits<double>::infinity())
+    {
+        std::vector<RegionPass> passes;
+        if (endDays <= startDays || this->catalog.Size() == 0)
+            return passes;
+
+        // 1. Orbit-shape pruning
+        std::vector<uint8_t> eligible(this->catalog.Size());
+        bool any = false;
+        for (size_t i = 0; i < this->catalog.Size(); ++i)
+        {
+            const OrbitShell& shell = this->shells[i];
+            double reach = shell.maxLatitude + 1.0; // geodetic vs geocentric latitude slack
+            eligible[i] = region.latMin <= reach && region.latMax >= -reach && shell.apogeeKm + this->ShellSlackKm >= minAltitudeKm &&
+                          shell.perigeeKm - this->ShellSlackKm <= maxAltitudeKm;
+            any = any || eligible[i];
+        }
+        if (!any)
+            return passes;
+
+        // 2. Coarse candidates from the cached index: cells within margin of the region
+        const Index& index = this->IndexFor(startDays, endDays);
+        double margin = index.marginDegrees;
+        int rowMin = std::max(0, (int)std::floor((region.latMin - margin + 90.0) / index.cellDegrees));
+        int rowMax = std::min(index.rows - 1, (int)std::floor((region.latMax + margin + 90.0) / index.cellDegrees));
+        // The margin is arc along the track; a degree of arc spans 1/cos(lat) degrees of longitude
+        double edge = std::max(std::fabs(region.latMin), std::fabs(region.latMax)) + margin;
+        double lonMargin = edge < 89.0 ? margin / cos(edge * PI / 180.0) : 360.0;
+        std::vector<uint8_t> nearRegion(index.cells + 1, 0);   // last entry stands for NoCell
+        for (int column : this->Columns(region, lonMargin, index))
+        {
+            for (int row = rowMin; row <= rowMax; ++row)
+                nearRegion[row * index.columns + column] = 1;
+        }
+
+        // 3. Exact refinement around candidate buckets
+        double bucketDays = index.bucketSeconds / 86400.0;
+        for (size_t i = 0; i < this->catalog.Size(); ++i)
+        {
+            if (!eligible[i])
+                continue;
+            const uint16_t* cells = &index.cellOf[i * index.buckets];
+            // Runs of candidate buckets at most two apart become one interval, widened by one bucket on both sides
+            int64_t first = -1, last = -1;
+            for (uint32_t bucket = 0; bucket <= index.buckets; ++bucket)
+            {
+                bool candidate = bucket < index.buckets && nearRegion[std::min<int>(cells[bucket], index.cells)];
+                if (candidate && first >= 0 && bucket <= last + 2)
+                {
+                    last = bucket;
+                    continue;
+                }
+                if (first >= 0 && (candidate || bucket == index.buckets))
+                {
+                    double from = std::max(startDays, startDays + ((double)first - 1.0) * bucketDays);
+                    double to = std::min(endDays, startDays + ((double)last + 1.0) * bucketDays);
+                    this->Refine(i, region, minAltitudeKm, maxAltitudeKm, from, to, passes);
+                    first = -1;
+                }
+                if (candidate)
+                    first = last = bucket;
+            }
+        }
+
+        // Intervals of one object may have split a pass at their shared edge
+        std::sort(passes.begin(), passes.end(), [](const RegionPass& a, const RegionPass& b) {
+            return a.norad != b.norad ? a.norad < b.norad : a.entryDays < b.entryDays;
+        });
+        std::vector<RegionPass> merged;
+        for (const RegionPass& pass : passes)
+        {
+            if (!merged.empty() && merged.back().norad == pass.norad && pass.entryDays <= merged.back().exitDays + 1e-9)
+                merged.back().exitDays = std::max(merged.back().exitDays, pass.exitDays);
+            else
+                merged.push_back(pass);
+        }
+        return merged;
+    }
+
+    size_t CacheHits() const { return this->hits; }
+    size_t CacheMisses() const { return this->misses; }
+
+private:
+    struct Index
+    {
+        double startDays;
+        double endDays;
+        double bucketSeconds;
+        double cellDegrees;
+        uint32_t buckets;
+        int rows, columns, cells;
+        double marginDegrees;
+        std::vector<uint16_t> cellOf;   // [object * buckets + bucket]: grid cell, or NoCell if propagation failed
+    };
+
+    static constexpr uint16_t NoCell = 0xFFFF;
+
+    const Catalog& catalog;
+    std::vector<OrbitShell> shells;
+    std::list<std::shared_ptr<Index>> indices;   // most recently used first
+    size_t hits;
+    size_t misses;
+
+    const Index& IndexFor(double startDays, double endDays)
+    {
+        for (auto it = this->indices.begin(); it != this->indices.end(); ++it)
+        {
+            const Index& index = **it;
+            if (index.startDays == startDays && index.endDays == endDays && index.bucketSeconds == this->BucketSeconds &&
+                index.cellDegrees == std::max(this->CellDegrees, 1.0))
+            {
+                ++this->hits;
+                Metrics::Instance().Add(METRIC_EPHEMERIS_CACHE_HITS);
+                this->indices.splice(this->indices.begin(), this->indices, it);
+                return *this->indices.front();
+            }
+        }
+        ++this->misses;
+        Metrics::Instance().Add(METRIC_EPHEMERIS_CACHE_MISSES);
+        this->indices.push_front(this->Build(startDays, endDays));
+        while (this->indices.size() > std::max<size_t>(this->CacheSize, 1))
+            this->indices.pop_back();
+        return *this->indices.front();
+    }
+
+    std::shared_ptr<Index> Build(double startDays, double endDays) const
+    {
+        std::shared_ptr<Index> index = std::make_shared<Index>();
+        size_t n = this->catalog.Size();
+        index->startDays = startDays;
+        index->endDays = endDays;
+        index->bucketSeconds = this->BucketSeconds;
+        index->cellDegrees = this->CellDegrees;
+        index->buckets = (uint32_t)std::ceil((endDays - startDays) * 86400.0 / index->bucketSeconds) + 1;
+        // Cell ids are 16-bit; finer than about 1 degree would overflow them
+        index->cellDegrees = std::max(index->cellDegrees, 1.0);
+        index->rows = (int)std::ceil(180.0 / index->cellDegrees);
+        index->columns = (int)std::ceil(360.0 / index->cellDegrees);
+        index->cells = index->rows * index->columns;
+        index->cellOf.assign(n * index->buckets, NoCell);
+
+        // A sample can be half a bucket away from where the object really was
+        double fastest = 0.0;
+        for (const OrbitShell& shell : this->shells)
+            fastest = std::max(fastest, shell.meanMotion);
+        index->marginDegrees = (360.0 * fastest / 86400.0 + 360.0 / 86164.0905) * index->bucketSeconds * 0.5 + index->cellDegrees * 0.5;
+
+        // Workers take whole objects so each propagator is only ever touched by one thread
+        // (deep-space SGP4 keeps integrator state between calls)
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < n; i = next++)
+            {
+                uint16_t* cells = &index->cellOf[i * index->buckets];
+                for (uint32_t bucket = 0; bucket < index->buckets; ++bucket)
+                {
+                    double days = std::min(endDays, startDays + bucket * index->bucketSeconds / 86400.0);
+                    double lat, lon, altitude;
+                    if (!sub_satellite_point(this->catalog, i, days, lat, lon, altitude))
+                        continue;
+                    int row = std::min(index->rows - 1, (int)((lat + 90.0) / index->cellDegrees));
+                    int column = std::min(index->columns - 1, (int)((lon + 180.0) / index->cellDegrees));
+                    cells[bucket] = (uint16_t)(row * index->columns + column);
+                }
+            }
+        };
+        unsigned threads = std::max(1u, std::min<unsigned>(std::thread::hardware_concurrency(), (unsigned)std::min<size_t>(n, 1024)));
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (std::thread& thread : pool)
+            thread.join();
+        return index;
+    }
+
+    // Grid columns overlapping the region's longitude span widened by margin, with wrap-around
+    std::vector<int> Columns(const GeoRegion& region, double margin, const Index& index) const
+    {
+        int columns = index.columns;
+        std::vector<int> result;
+        double span = region.lonMin <= region.lonMax ? region.lonMax - region.lonMin : region.lonMax + 360.0 - region.lonMin;
+        if (span + 2.0 * margin >= 360.0)
+        {
+            for (int column = 0; column < columns; ++column)
+                result.push_back(column);
+            return result;
+        }
+        int first = (int)std::floor((region.lonMin - margin + 180.0) / index.cellDegrees);
+        int last = (int)std::floor((region.lonMin + span + margin + 180.0) / index.cellDegrees);
+        for (int column = first; column <= last; ++column)
+            result.push_back(((column % columns) + columns) % columns);
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    bool Inside(size_t index, const GeoRegion& region, double minAltitudeKm, double maxAltitudeKm, double days) const
+    {
+        double lat, lon, altitude;
+        return sub_satellite_point(this->catalog, index, days, lat, lon, altitude) && altitude >= minAltitudeKm &&
+               altitude <= maxAltitudeKm && region.Contains(lat, lon);
+    }
+
+    // Bisection for the instant the inside/outside state flips between a and b
+    double Crossing(size_t index, const GeoRegion& region, double minAltitudeKm, double maxAltitudeKm, double a, double b,
+                    bool insideAtA) const
+    {
+        double tolerance = this->TimeToleranceSeconds / 86400.0;
+        while (b - a > tolerance)
+        {
+            double mid = 0.5 * (a + b);
+            if (this->Inside(index, region, minAltitudeKm, maxAltitudeKm, mid) == insideAtA)
+                a = mid;
+            else
+                b = mid;
+        }
+        return 0.5 * (a + b);
+    }
+
+    void Refine(size_t index, const GeoRegion& region, double minAltitudeKm, double maxAltitudeKm, double from, double to,
+                std::vector<RegionPass>& passes) const
+    {
+        double step = this->RefineStepSeconds / 86400.0;
+        bool inside = this->Inside(index, region, minAltitudeKm, maxAltitudeKm, from);
+        double entry = from;
+        double previous = from;
+        for (double t = std::min(from + step, to);; t = std::min(t + step, to))
+        {
+            bool now = this->Inside(index, region, minAltitudeKm, maxAltitudeKm, t);
+            if (now != inside)
+            {
+                double crossing = this->Crossing(index, region, minAltitudeKm, maxAltitudeKm, previous, t, inside);
+                if (now)
+                    entry = crossing;
+                else
+                    passes.push_back({ this->catalog.HandleAt(index), this->catalog.NoradNumberAt(index), entry, crossing });
+                inside = now;
+            }
+            previous = t;
+            if (t >= to)
+                break;
+        }
+        if (inside)
+            passes.push_back({ this->catalog.HandleAt(index), this->catalog.NoradNumberAt(index), entry, to });
+    }
+};
+
+// High-latitude regression: the most inclined object over a ring of 10-degree boxes just below its turning
+// latitude for one day, against a 1 s scan. Every scanned pass longer than two refinement steps must come
+// back from Query; this is where the longitude margin is widest.
+inline bool check_region_query(const Catalog& catalog)
+{
+    size_t polar = catalog.Size();
+    double reach = 0.0;
+    for (size_t i = 0; i < catalog.Size(); ++i)
+    {
+        OrbitShell shell(catalog.InfoAt(i).line2);
+        if (shell.maxLatitude > reach)
+        {
+            reach = shell.maxLatitude;
+            polar = i;
+        }
+    }
+    if (polar == catalog.Size() || reach < 75.0)
+        return true;
+    double startDays = catalog.EpochDaysAt(polar);
+    double endDays = startDays + 1.0;
+    double step = 1.0 / 86400.0, tolerance = 2.0 / 86400.0;
+
+    std::vector<glm::dvec2> track;   // (lat, lon) per second; NaN where propagation failed
+    for (double t = startDays; t <= endDays; t += step)
+    {
+        double lat, lon, altitude;
+        if (!sub_satellite_point(catalog, polar, t, lat, lon, altitude))
+            lat = lon = std::numeric_limits<double>::quiet_NaN();
+        track.push_back(glm::dvec2(lat, lon));
+    }
+
+    RegionQueryEngine engine(catalog);
+    for (double lonMin = -180.0; lonMin < 180.0; lonMin += 10.0)
+    {
+        GeoRegion region = GeoRegion::Box(reach - 3.0, reach, lonMin, lonMin + 10.0);
+        std::vector<RegionPass> passes = engine.Query(region, startDays, endDays);
+        bool inside = false;
+        double entry = startDays;
+        for (size_t k = 0; k <= track.size(); ++k)
+        {
+            double t = startDays + k * step;
+            bool now = k < track.size() && region.Contains(track[k].x, track[k].y);
+            if (now && !inside)
+                entry = t;
+            if (!now && inside && t - entry >= 2.0 * engine.RefineStepSeconds / 86400.0)
+            {
+                bool found = false;
+                for (const RegionPass& pass : passes)
+                {
+                    found = found || (pass.norad == catalog.NoradNumberAt(polar) && std::fabs(pass.entryDays - entry) <= tolerance &&
+                                      std::fabs(pass.exitDays - std::min(t, endDays)) <= tolerance);
+                }
+                if (!found)
+                {
+                    std::cout << "ERROR::REGION_QUERY::PASS_MISSED: " << catalog.NoradNumberAt(polar) << " over lon " << lonMin
+                              << " entering at day " << std::fixed << std::setprecision(6) << entry << std::defaultfloat << std::endl;
+                    return false;
+                }
+            }
+            inside = now;
+        }
+    }
+    return true;
+}
+
+// Headless entry point: passes over a lat/lon box during the `hours` after the newest catalog epoch,
+// printed as norad,entry_days,exit_days. The query runs twice to show the cached-index time.
+inline int run_region_query(const std::string& catalogPath, double latMin, double latMax, double lonMin, double lonMax, double hours)
+{
+    Catalog catalog;
+    if (!catalog.LoadFromFile(catalogPath) || catalog.Size() == 0 || hours <= 0.0)
+        return 2;
+    double startDays = 0.0;
+    for (size_t i = 0; i < catalog.Size(); ++i)
+        startDays = std::max(startDays, catalog.EpochDaysAt(i));
+    GeoRegion region = GeoRegion::Box(latMin, latMax, lonMin, lonMax);
+
+    RegionQueryEngine engine(catalog);
+    std::vector<RegionPass> passes;
+    for (const char* label : { "cold", "cached" })
+    {
+        auto start = std::chrono::steady_clock::now();
+        passes = engine.Query(region, startDays, startDays + hours / 24.0);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "# " << label << " query: " << passes.size() << " passes in " << ms << " ms" << std::endl;
+    }
+    std::cout << "norad,entry_days,exit_days" << std::endl;
+    std::cout << std::fixed << std::setprecision(6);
+    for (const RegionPass& pass : passes)
+        std::cout << pass.norad << "," << pass.entryDays << "," << pass.exitDays << "\n";
+    return 0;
+}
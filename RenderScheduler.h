@@ -0,0 +1,191 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <iostream>
+
+// GL Includes
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "Shader.h"
+
+// What changed since the last presented frame
+enum RenderDirty : unsigned
+{
+    DIRTY_CAMERA = 1 << 0,      // camera pose or zoom
+    DIRTY_TIME = 1 << 1,        // simulation clock advanced
+    DIRTY_UI = 1 << 2,          // input that only ImGui cares about
+    DIRTY_CATALOG = 1 << 3,     // catalog reloaded or selection changed
+    DIRTY_SCENE = 1 << 4,       // anything else that invalidates the 3D scene (shader reload, window expose)
+};
+
+enum RenderPass
+{
+    RENDER_PASS_NONE,   // nothing to draw this iteration
+    RENDER_PASS_UI,     // cached scene + ImGui
+    RENDER_PASS_SCENE   // everything
+};
+
+// Damage-driven frame pacing for the viewer loop.
+//
+// Input callbacks and the loop Mark() what they changed. WaitForFrame() blocks in glfwWaitEventsTimeout
+// until something is dirty and the frame cap of the current mode allows a new frame, then tells the loop
+// which passes to draw. A scene pass ends with CaptureScene(), which resolves the default framebuffer
+// into a texture; UI-only passes (paused, static camera, cursor over ImGui) start with DrawCachedScene()
+// instead of redrawing the Earth, the catalog and the labels.
+class RenderScheduler
+{
+public:
+    // Frame caps per mode, frames per second; 0 means uncapped (vsync only)
+    double RunningFps;       // simulation clock running
+    double InteractiveFps;   // paused, camera or scene changing
+    double UiFps;            // paused, only ImGui changing
+    // How long an idle loop sleeps before it wakes up for housekeeping (shader hot reload), seconds
+    double IdleTimeout;
+    // ImGui needs a couple of frames after an event to settle hover/active states
+    int UiSettleFrames;
+    // Off during session replay: every iteration becomes a scene pass, nothing waits
+    bool Enabled;
+
+    RenderScheduler()
+        : RunningFps(60.0), InteractiveFps(60.0), UiFps(30.0), IdleTimeout(0.5), UiSettleFrames(3), Enabled(true),
+          dirty(DIRTY_SCENE), settle(0), lastFrameTime(0.0), width(0), height(0), framebuffer(0), texture(0), VAO(0),
+          sceneFrames(0), uiFrames(0), idleWakeups(0)
+    {
+    }
+
+    void Mark(unsigned flags)
+    {
+        this->dirty |= flags;
+        if (flags & DIRTY_UI)
+            this->settle = this->UiSettleFrames;
+    }
+
+    RenderPass WaitForFrame(bool simulationRunning)
+    {
+        if (!this->Enabled)
+        {
+            glfwPollEvents();
+            return RENDER_PASS_SCENE;
+        }
+        for (;;)
+        {
+            unsigned pending = this->dirty | (simulationRunning ? DIRTY_TIME : 0u);
+            if (pending == 0)
+            {
+                glfwWaitEventsTimeout(this->IdleTimeout);
+                if (this->dirty == 0)
+                {
+                    ++this->idleWakeups;
+                    return RENDER_PASS_NONE;
+                }
+                continue;
+            }
+
+            double cap = simulationRunning ? this->RunningFps : (pending & ~DIRTY_UI) ? this->InteractiveFps : this->UiFps;
+            double now = glfwGetTime();
+            double wait = cap > 0.0 ? this->lastFrameTime + 1.0 / cap - now : 0.0;
+            if (wait > 0.0)
+            {
+                // Events that arrive meanwhile are handled (and marked) by the callbacks
+                glfwWaitEventsTimeout(wait);
+                continue;
+            }
+            // Frames are spaced start to start, so the cap doesn't also count the time spent drawing and swapping
+            this->lastFrameTime = now;
+            glfwPollEvents();
+            pending |= this->dirty;
+            // Marks made while the frame is being built belong to the next one
+            this->dirty = 0;
+            if (this->settle > 0 && --this->settle > 0)
+                this->dirty = DIRTY_UI;
+            return (pending & ~DIRTY_UI) || !this->texture ? RENDER_PASS_SCENE : RENDER_PASS_UI;
+        }
+    }
+
+    // Called after the frame has been presented
+    void FrameDone(RenderPass pass)
+    {
+        if (pass == RENDER_PASS_NONE)
+            return;
+        if (pass == RENDER_PASS_SCENE)
+            ++this->sceneFrames;
+        else
+            ++this->uiFrames;
+    }
+
+    // Resolves the default framebuffer (multisampled or not) into the cache texture; call before ImGui is drawn
+    void CaptureScene(int width, int height)
+    {
+        if (!this->Enabled)
+            return;
+        if (width != this->width || height != this->height)
+            this->Resize(width, height);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->framebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Fullscreen triangle with the cached scene. A blit back would fail on a multisampled default framebuffer.
+    void DrawCachedScene(Shader& shader)
+    {
+        glDisable(GL_DEPTH_TEST);
+        shader.Use();
+        glUniform1i(glGetUniformLocation(shader.Program, "scene"), 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, this->texture);
+        glBindVertexArray(this->VAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    size_t SceneFrames() const { return this->sceneFrames; }
+    size_t UiFrames() const { return this->uiFrames; }
+    size_t IdleWakeups() const { return this->idleWakeups; }
+
+    void Release()
+    {
+        glDeleteFramebuffers(1, &this->framebuffer);
+        glDeleteTextures(1, &this->texture);
+        glDeleteVertexArrays(1, &this->VAO);
+        this->framebuffer = this->texture = this->VAO = 0;
+        this->width = this->height = 0;
+    }
+
+private:
+    unsigned dirty;
+    int settle;
+    double lastFrameTime;
+    int width, height;
+    GLuint framebuffer, texture, VAO;
+    size_t sceneFrames;
+    size_t uiFrames;
+    size_t idleWakeups;
+
+    void Resize(int width, int height)
+    {
+        if (!this->framebuffer)
+        {
+            glGenFramebuffers(1, &this->framebuffer);
+            glGenTextures(1, &this->texture);
+            // The fullscreen triangle comes from gl_VertexID, but core profile still needs a VAO
+            glGenVertexArrays(1, &this->VAO);
+        }
+        glBindTexture(GL_TEXTURE_2D, this->texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->texture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::RENDER_SCHEDULER::FRAMEBUFFER_NOT_COMPLETE" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        this->width = width;
+        this->height = height;
+    }
+};
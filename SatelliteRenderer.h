@@ -0,0 +1,127 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+
+// GL Includes
+#include <GL/glew.h>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/type_ptr.hpp>
+
+#include "Shader.h"
+#include "Culling.h"
+#include "Metrics.h"
+
+// Instanced drawing of the culled catalog: one instance buffer per frame holding the cube survivors followed
+// by the point-sprite survivors, one glDrawElementsInstanced for the cubes and one glDrawArrays for the points.
+class SatelliteRenderer
+{
+public:
+    // Cube edge in scene units (Earth radii)
+    float CubeScale;
+    // Point sprite diameter, pixels
+    float PointSize;
+    glm::vec3 Color;
+
+    SatelliteRenderer()
+        : CubeScale(0.01f), PointSize(2.0f), Color(1.0f, 1.0f, 1.0f), cubeVAO(0), pointVAO(0), instanceVBO(0), indexCount(0),
+          cubeCount(0), pointCount(0), uploadedBytes(0)
+    {
+    }
+
+    // Uses the existing cube mesh: 3 floats per vertex in meshVBO, a triangle list in meshEBO
+    void Init(GLuint meshVBO, GLuint meshEBO, GLsizei indexCount)
+    {
+        this->indexCount = indexCount;
+        glGenVertexArrays(1, &this->cubeVAO);
+        glGenVertexArrays(1, &this->pointVAO);
+        glGenBuffers(1, &this->instanceVBO);
+
+        glBindVertexArray(this->cubeVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshEBO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+
+        // Points read the same buffer as plain vertices; attribute 0 stays disabled and reads as (0,0,0)
+        glBindVertexArray(this->pointVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+        glEnableVertexAttribArray(1);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void Upload(const SatelliteCuller& culler)
+    {
+        this->cubeCount = culler.Cubes().size();
+        this->pointCount = culler.Points().size();
+        size_t bytes = (this->cubeCount + this->pointCount) * sizeof(glm::vec3);
+        glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+        // Orphan last frame's storage so the driver doesn't wait for draws still reading it
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        if (this->cubeCount > 0)
+            glBufferSubData(GL_ARRAY_BUFFER, 0, this->cubeCount * sizeof(glm::vec3), culler.Cubes().data());
+        if (this->pointCount > 0)
+            glBufferSubData(GL_ARRAY_BUFFER, this->cubeCount * sizeof(glm::vec3), this->pointCount * sizeof(glm::vec3), culler.Points().data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        this->uploadedBytes += bytes;
+        Metrics::Instance().Add(METRIC_UPLOAD_BYTES, bytes);
+    }
+
+    void Draw(Shader& shader, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection)
+    {
+        if (this->cubeCount + this->pointCount == 0)
+            return;
+        shader.Use();
+        shader.setMat4("model", model);
+        shader.setMat4("view", view);
+        shader.setMat4("projection", projection);
+        glUniform1f(glGetUniformLocation(shader.Program, "cubeScale"), this->CubeScale);
+        glUniform1f(glGetUniformLocation(shader.Program, "pointSize"), this->PointSize);
+        glUniform3f(glGetUniformLocation(shader.Program, "color"), this->Color.x, this->Color.y, this->Color.z);
+
+        if (this->cubeCount > 0)
+        {
+            glUniform1i(glGetUniformLocation(shader.Program, "points"), 0);
+            glBindVertexArray(this->cubeVAO);
+            glDrawElementsInstanced(GL_TRIANGLES, this->indexCount, GL_UNSIGNED_INT, 0, (GLsizei)this->cubeCount);
+        }
+        if (this->pointCount > 0)
+        {
+            glUniform1i(glGetUniformLocation(shader.Program, "points"), 1);
+            glEnable(GL_PROGRAM_POINT_SIZE);
+            glBindVertexArray(this->pointVAO);
+            glDrawArrays(GL_POINTS, (GLint)this->cubeCount, (GLsizei)this->pointCount);
+            glDisable(GL_PROGRAM_POINT_SIZE);
+        }
+        glBindVertexArray(0);
+    }
+
+    // Vertices processed by the last Draw (one per cube index per instance, one per point)
+    size_t VertexCount() const { return this->cubeCount * this->indexCount + this->pointCount; }
+    size_t CubeCount() const { return this->cubeCount; }
+    size_t PointCount() const { return this->pointCount; }
+    // Total bytes written to the instance buffer since start
+    size_t UploadedBytes() const { return this->uploadedBytes; }
+
+    void Release()
+    {
+        glDeleteVertexArrays(1, &this->cubeVAO);
+        glDeleteVertexArrays(1, &this->pointVAO);
+        glDeleteBuffers(1, &this->instanceVBO);
+        this->cubeVAO = this->pointVAO = this->instanceVBO = 0;
+    }
+
+private:
+    GLuint cubeVAO, pointVAO, instanceVBO;
+    GLsizei indexCount;
+    size_t cubeCount;
+    size_t pointCount;
+    size_t uploadedBytes;
+};
@@ -0,0 +1,266 @@
+#pragma once
+
+// Std. Includes
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+#include <glm/glm/glm.hpp>
+
+// Deterministic session recording for reproducible rendering benchmarks.
+//
+// Log layout: "STRK" magic, uint32 version, then a stream of records, each a one-byte type followed
+// by its packed payload. Input events are logged as they arrive; once per frame a FRAME record stores
+// the state the frame was rendered with (camera pose, simulation clock, speed, pause). Replay applies
+// the FRAME records directly, so it does not depend on wall-clock deltas or live input.
+
+enum SessionRecordType : uint8_t
+{
+    SESSION_FRAME = 1,
+    SESSION_KEY = 2,
+    SESSION_CURSOR = 3,
+    SESSION_SCROLL = 4
+};
+
+struct SessionFrame
+{
+    float deltaTime;
+    float simulationTime;
+    float animationSpeed;
+    uint8_t paused;
+    uint8_t cameraMode;
+    glm::vec3 cameraPosition;
+    float yaw;
+    float pitch;
+    float zoom;
+};
+
+const char SESSION_MAGIC[4] = { 'S', 'T', 'R', 'K' };
+const uint32_t SESSION_VERSION = 1;
+
+class SessionRecorder
+{
+public:
+    bool Open(const std::string& path)
+    {
+        this->file.open(path, std::ios::binary);
+        if (!this->file.is_open())
+        {
+            std::cout << "ERROR::SESSION::FILE_NOT_SUCCESFULLY_OPENED: " << path << std::endl;
+            return false;
+        }
+        this->file.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+        this->Put(SESSION_VERSION);
+        return true;
+    }
+
+    bool Active() const { return this->file.is_open(); }
+
+    void RecordKey(int key, int action)
+    {
+        if (!this->Active())
+            return;
+        this->Put(SESSION_KEY);
+        this->Put((int16_t)key);
+        this->Put((int8_t)action);
+    }
+
+    void RecordCursor(double x, double y)
+    {
+        if (!this->Active())
+            return;
+        this->Put(SESSION_CURSOR);
+        this->Put((float)x);
+        this->Put((float)y);
+    }
+
+    void RecordScroll(double yoffset)
+    {
+        if (!this->Active())
+            return;
+        this->Put(SESSION_SCROLL);
+        this->Put((float)yoffset);
+    }
+
+    void RecordFrame(const SessionFrame& frame)
+    {
+        if (!this->Active())
+            return;
+        this->Put(SESSION_FRAME);
+        this->Put(frame.deltaTime);
+        this->Put(frame.simulationTime);
+        this->Put(frame.animationSpeed);
+        this->Put(frame.paused);
+        this->Put(frame.cameraMode);
+        this->Put(frame.cameraPosition.x);
+        this->Put(frame.cameraPosition.y);
+        this->Put(frame.cameraPosition.z);
+        this->Put(frame.yaw);
+        this->Put(frame.pitch);
+        this->Put(frame.zoom);
+    }
+
+    void Close() { this->file.close(); }
+
+private:
+    std::ofstream file;
+
+    template <typename T>
+    void Put(T value) { this->file.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+};
+
+class SessionReplayer
+{
+public:
+    // Wall-clock step handed to the loop during replay, seconds
+    float FixedStep;
+
+    SessionReplayer() : FixedStep(1.0f / 60.0f), events(0) {}
+
+    bool Open(const std::string& path)
+    {
+        this->file.open(path, std::ios::binary);
+        char magic[4];
+        uint32_t version = 0;
+        if (!this->file.is_open() || !this->file.read(magic, sizeof(magic)) || std::memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0 ||
+            !this->Get(version) || version != SESSION_VERSION)
+        {
+            std::cout << "ERROR::SESSION::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            this->file.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool Active() const { return this->file.is_open(); }
+
+    // Advances to the next FRAME record. Input events in between are skipped and counted;
+    // the frame state already reflects their effect. Returns false at the end of the log.
+    bool NextFrame(SessionFrame& frame)
+    {
+        uint8_t type;
+        while (this->Get(type))
+        {
+            switch (type)
+            {
+            case SESSION_FRAME:
+                return this->Get(frame.deltaTime) && this->Get(frame.simulationTime) && this->Get(frame.animationSpeed) &&
+                       this->Get(frame.paused) && this->Get(frame.cameraMode) && this->Get(frame.cameraPosition.x) &&
+                       this->Get(frame.cameraPosition.y) && this->Get(frame.cameraPosition.z) && this->Get(frame.yaw) &&
+                       this->Get(frame.pitch) && this->Get(frame.zoom);
+            case SESSION_KEY:
+                this->file.ignore(sizeof(int16_t) + sizeof(int8_t));
+                break;
+            case SESSION_CURSOR:
+                this->file.ignore(sizeof(float) * 2);
+                break;
+            case SESSION_SCROLL:
+                this->file.ignore(sizeof(float));
+                break;
+            default:
+                std::cout << "ERROR::SESSION::UNKNOWN_RECORD " << (int)type << std::endl;
+                return false;
+            }
+            ++this->events;
+        }
+        return false;
+    }
+
+    size_t Events() const { return this->events; }
+
+private:
+    std::ifstream file;
+    size_t events;
+
+    template <typename T>
+    bool Get(T& value) { return (bool)this->file.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+};
+
+// Per-frame CPU and GPU timings. GPU time comes from GL_TIME_ELAPSED queries read back a few
+// frames late so the CPU never waits for the GPU.
+class FrameTimer
+{
+public:
+    FrameTimer() : current(0), started(false) {}
+
+    void BeginFrame()
+    {
+        if (!this->queries[0])
+            glGenQueries(QUERY_LATENCY, this->queries);
+        this->cpuStart = std::chrono::steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, this->queries[this->current % QUERY_LATENCY]);
+        this->started = true;
+    }
+
+    void EndFrame()
+    {
+        if (!this->started)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        this->cpu.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->cpuStart).count());
+        this->gpu.push_back(-1.0);
+        ++this->current;
+        this->started = false;
+
+        // The next frame reuses the query slot of frame current - QUERY_LATENCY, so read that result now
+        if (this->current >= QUERY_LATENCY)
+            this->Collect(this->current - QUERY_LATENCY);
+    }
+
+    // Writes frame,cpu_ms,gpu_ms rows followed by summary lines; returns false if the file can't be opened
+    bool WriteReport(const std::string& path)
+    {
+        for (size_t frame = this->current >= QUERY_LATENCY ? this->current - QUERY_LATENCY + 1 : 0; frame < this->current; ++frame)
+            this->Collect(frame);
+        std::ofstream file(path);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::SESSION::REPORT_NOT_SUCCESFULLY_OPENED: " << path << std::endl;
+            return false;
+        }
+        file << "frame,cpu_ms,gpu_ms\n";
+        for (size_t i = 0; i < this->cpu.size(); ++i)
+            file << i << "," << this->cpu[i] << "," << this->gpu[i] << "\n";
+        WriteSummary(file, "cpu", this->cpu);
+        WriteSummary(file, "gpu", this->gpu);
+        return true;
+    }
+
+private:
+    static const size_t QUERY_LATENCY = 4;
+
+    GLuint queries[QUERY_LATENCY] = {};
+    size_t current;
+    bool started;
+    std::chrono::steady_clock::time_point cpuStart;
+    std::vector<double> cpu;
+    std::vector<double> gpu;
+
+    void Collect(size_t frame)
+    {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(this->queries[frame % QUERY_LATENCY], GL_QUERY_RESULT, &elapsed);
+        this->gpu[frame] = elapsed / 1.0e6;
+    }
+
+    static void WriteSummary(std::ostream& out, const char* name, std::vector<double> values)
+    {
+        values.erase(std::remove(values.begin(), values.end(), -1.0), values.end());
+        if (values.empty())
+            return;
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (double value : values)
+            sum += value;
+        auto percentile = [&](double p) { return values[std::min(values.size() - 1, (size_t)(p * values.size()))]; };
+        out << "# " << name << " mean " << sum / values.size() << " p50 " << percentile(0.5) << " p95 " << percentile(0.95)
+            << " p99 " << percentile(0.99) << " max " << values.back() << " ms\n";
+    }
+};
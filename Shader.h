@@ -5,6 +5,11 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
 
 #include <GL/glew.h> //  glew  ,       OpenGL
 #include <glm/glm/gtc/type_ptr.hpp> //  glm::value_ptr
@@ -18,16 +23,133 @@ public:
     Shader(const GLchar* vertexPath, const GLchar* fragmentPath);
     //  
     void Use();
+    //      (GL_KHR_parallel_shader_compile)
+    bool IsReady() const;
+    //  ,   ;     
+    bool ReloadIfChanged();
 
     void setMat4(const std::string& name, const glm::mat4& mat) const {
         glUniformMatrix4fv(glGetUniformLocation(Program, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
     }
+
+    //     (glGetProgramBinary)
+    static std::string& CacheDirectory() { static std::string directory = "shader_cache"; return directory; }
+    //   ReloadIfChanged    
+    static std::chrono::milliseconds& ReloadInterval() { static std::chrono::milliseconds interval(500); return interval; }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::filesystem::file_time_type vertexTime;
+    std::filesystem::file_time_type fragmentTime;
+    std::chrono::steady_clock::time_point lastCheck;
+    std::string cachePath;
+    // ,    ;     Use()
+    GLuint pendingVertex;
+    GLuint pendingFragment;
+
+    static bool ReadSources(const std::string& vertexPath, const std::string& fragmentPath, std::string& vertexCode, std::string& fragmentCode);
+    static std::string CacheFile(const std::string& vertexCode, const std::string& fragmentCode);
+    static bool BinaryCacheSupported() { return GLEW_ARB_get_program_binary || GLEW_VERSION_4_1; }
+    static void EnableParallelCompile();
+    static GLuint StartBuild(const std::string& vertexCode, const std::string& fragmentCode, GLuint& vertex, GLuint& fragment);
+    static bool FinishBuild(GLuint program, GLuint vertex, GLuint fragment);
+    static GLuint LoadBinary(const std::string& path);
+    static void SaveBinary(GLuint program, const std::string& path);
+    void Finish();
+    void UpdateTimes();
 };
 
-Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath){
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath)
+    : Program(0), vertexPath(vertexPath), fragmentPath(fragmentPath), lastCheck(std::chrono::steady_clock::now()), pendingVertex(0), pendingFragment(0)
+{
     // 1.      filePath
     std::string vertexCode;
     std::string fragmentCode;
+    ReadSources(this->vertexPath, this->fragmentPath, vertexCode, fragmentCode);
+    this->UpdateTimes();
+
+    // 2. Ҹ :    ,  
+    this->cachePath = CacheFile(vertexCode, fragmentCode);
+    if (BinaryCacheSupported())
+    {
+        this->Program = LoadBinary(this->cachePath);
+        if (this->Program)
+            return;
+    }
+
+    // 3.  :  ,     ,
+    //       
+    EnableParallelCompile();
+    this->Program = StartBuild(vertexCode, fragmentCode, this->pendingVertex, this->pendingFragment);
+}
+
+void Shader::Use()
+{
+    if (this->pendingVertex || this->pendingFragment)
+        this->Finish();
+    glUseProgram(this->Program);
+}
+
+bool Shader::IsReady() const
+{
+    if (!this->pendingVertex && !this->pendingFragment)
+        return true;
+#ifdef GL_KHR_parallel_shader_compile
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLint done = GL_FALSE;
+        glGetProgramiv(this->Program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+#endif
+    return false;
+}
+
+bool Shader::ReloadIfChanged()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - this->lastCheck < ReloadInterval())
+        return false;
+    this->lastCheck = now;
+
+    std::error_code error;
+    auto vertexTime = std::filesystem::last_write_time(this->vertexPath, error);
+    if (error)
+        return false;
+    auto fragmentTime = std::filesystem::last_write_time(this->fragmentPath, error);
+    if (error || (vertexTime == this->vertexTime && fragmentTime == this->fragmentTime))
+        return false;
+    this->vertexTime = vertexTime;
+    this->fragmentTime = fragmentTime;
+
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!ReadSources(this->vertexPath, this->fragmentPath, vertexCode, fragmentCode))
+        return false;
+
+    //             
+    GLuint vertex, fragment;
+    GLuint program = StartBuild(vertexCode, fragmentCode, vertex, fragment);
+    if (!FinishBuild(program, vertex, fragment))
+    {
+        std::cout << "ERROR::SHADER::RELOAD_FAILED, keeping previous program: " << this->vertexPath << " " << this->fragmentPath << std::endl;
+        glDeleteProgram(program);
+        return false;
+    }
+    if (this->pendingVertex || this->pendingFragment)
+        this->Finish();
+    glDeleteProgram(this->Program);
+    this->Program = program;
+    this->cachePath = CacheFile(vertexCode, fragmentCode);
+    if (BinaryCacheSupported())
+        SaveBinary(this->Program, this->cachePath);
+    std::cout << "SHADER::RELOADED " << this->vertexPath << " " << this->fragmentPath << std::endl;
+    return true;
+}
+
+bool Shader::ReadSources(const std::string& vertexPath, const std::string& fragmentPath, std::string& vertexCode, std::string& fragmentCode)
+{
     std::ifstream vShaderFile;
     std::ifstream fShaderFile;
     // ,  ifstream    
@@ -50,19 +172,71 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath){
     }
     catch (std::ifstream::failure e){
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        return false;
     }
+    return true;
+}
+
+std::string Shader::CacheFile(const std::string& vertexCode, const std::string& fragmentCode)
+{
+    //  : FNV-1a     ,     
+    auto glString = [](GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? std::string(reinterpret_cast<const char*>(value)) : std::string();
+    };
+    std::string key = vertexCode + '\0' + fragmentCode + '\0' + glString(GL_VENDOR) + '\0' + glString(GL_RENDERER) + '\0' + glString(GL_VERSION);
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    std::ostringstream name;
+    name << CacheDirectory() << "/" << std::hex << hash << ".bin";
+    return name.str();
+}
+
+void Shader::EnableParallelCompile()
+{
+    static bool enabled = false;
+    if (enabled)
+        return;
+    enabled = true;
+#ifdef GL_KHR_parallel_shader_compile
+    if (GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); //     
+#endif
+}
+
+GLuint Shader::StartBuild(const std::string& vertexCode, const std::string& fragmentCode, GLuint& vertex, GLuint& fragment)
+{
     const GLchar* vShaderCode = vertexCode.c_str();
     const GLchar* fShaderCode = fragmentCode.c_str();
 
-    // 2.  
-    GLuint vertex, fragment;
-    GLint success;
-    GLchar infoLog[512];
-
     //  
     vertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex, 1, &vShaderCode, NULL);
     glCompileShader(vertex);
+
+    fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fShaderCode, NULL);
+    glCompileShader(fragment);
+
+    //  
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (BinaryCacheSupported())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+    return program;
+}
+
+bool Shader::FinishBuild(GLuint program, GLuint vertex, GLuint fragment)
+{
+    GLint success;
+    GLchar infoLog[512];
+
     //    -  
     glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
     if (!success)
@@ -70,10 +244,6 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath){
         glGetShaderInfoLog(vertex, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
     };
-
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
     //    -  
     glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
     if (!success)
@@ -81,24 +251,75 @@ Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath){
         glGetShaderInfoLog(fragment, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
     };
-
-    //  
-    this->Program = glCreateProgram();
-    glAttachShader(this->Program, vertex);
-    glAttachShader(this->Program, fragment);
-    glLinkProgram(this->Program);
     //   -  
-    glGetProgramiv(this->Program, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success)
     {
-        glGetProgramInfoLog(this->Program, 512, NULL, infoLog);
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
     }
 
     //  ,          .
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    return success == GL_TRUE;
+}
+
+GLuint Shader::LoadBinary(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+    GLenum format = 0;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof())
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        //    (  ..) -   
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void Shader::SaveBinary(GLuint program, const std::string& path)
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(CacheDirectory(), error);
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return;
+    file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+    file.write(binary.data(), binary.size());
 }
 
-void Shader::Use() { glUseProgram(this->Program); }
+void Shader::Finish()
+{
+    bool success = FinishBuild(this->Program, this->pendingVertex, this->pendingFragment);
+    this->pendingVertex = this->pendingFragment = 0;
+    if (success && BinaryCacheSupported())
+        SaveBinary(this->Program, this->cachePath);
+}
+
+void Shader::UpdateTimes()
+{
+    std::error_code error;
+    this->vertexTime = std::filesystem::last_write_time(this->vertexPath, error);
+    this->fragmentTime = std::filesystem::last_write_time(this->fragmentPath, error);
+}
 #endif
@@ -0,0 +1,165 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// GL Includes
+#include <glm/glm/glm.hpp>
+
+// SGP4 Includes
+#include <SGP4.h>
+
+#include "OrbitMath.h"
+#include "Metrics.h"
+
+// One record of a streamed ephemeris: TEME state in km and km/s
+struct EphemerisRecord
+{
+    double days;
+    double x, y, z;
+    double vx, vy, vz;
+};
+
+// Long-horizon track of a single object. SGP4 is closed-form in time, so the
+// time range is cut into chunks that are propagated independently on all cores.
+class TrackPropagator
+{
+public:
+    // Samples per work item; large enough to amortise the atomic, small enough to balance
+    static const size_t CHUNK_SIZE = 4096;
+
+    TrackPropagator(const libsgp4::SGP4& sgp4, double epochDays, unsigned threads = 0)
+        : sgp4(sgp4), epochDays(epochDays), threadCount(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    // Fills out[0..count) with scene-frame positions for startDays + i * stepSeconds * downsample.
+    // Returns the number of valid samples; it is smaller than count if the object decayed inside the range.
+    size_t Propagate(double startDays, double stepSeconds, size_t count, glm::vec3* out, size_t downsample = 1) const
+    {
+        double step = stepSeconds * std::max<size_t>(downsample, 1) / 86400.0;
+        return this->Run(count, [&](const libsgp4::SGP4& local, size_t i) {
+            double days = startDays + i * step;
+            out[i] = eci_to_scene(local.FindPosition((days - this->epochDays) * 1440.0), days);
+        });
+    }
+
+    std::vector<glm::vec3> Propagate(double startDays, double stepSeconds, size_t count, size_t downsample = 1) const
+    {
+        std::vector<glm::vec3> points(count);
+        points.resize(this->Propagate(startDays, stepSeconds, count, points.data(), downsample));
+        return points;
+    }
+
+    // Fills out[0..count) with TEME states; same sampling and return value as Propagate()
+    size_t PropagateStates(double startDays, double stepSeconds, size_t count, EphemerisRecord* out, size_t downsample = 1) const
+    {
+        double step = stepSeconds * std::max<size_t>(downsample, 1) / 86400.0;
+        return this->Run(count, [&](const libsgp4::SGP4& local, size_t i) {
+            double days = startDays + i * step;
+            libsgp4::Eci eci = local.FindPosition((days - this->epochDays) * 1440.0);
+            out[i] = { days, eci.Position().x, eci.Position().y, eci.Position().z,
+                       eci.Velocity().x, eci.Velocity().y, eci.Velocity().z };
+        });
+    }
+
+    // Writes count EphemerisRecords to path in time order, window by window, so memory stays bounded
+    // by threads * CHUNK_SIZE records. Returns the number of records written.
+    size_t StreamToFile(const std::string& path, double startDays, double stepSeconds, size_t count, size_t downsample = 1) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::TRACK::FILE_NOT_SUCCESFULLY_OPENED: " << path << std::endl;
+            return 0;
+        }
+        double step = stepSeconds * std::max<size_t>(downsample, 1);
+        size_t window = this->threadCount * CHUNK_SIZE * 4;
+        std::vector<EphemerisRecord> buffer(std::min(window, count));
+
+        size_t written = 0;
+        while (written < count)
+        {
+            size_t n = std::min(window, count - written);
+            size_t valid = this->PropagateStates(startDays + written * step / 86400.0, step, n, buffer.data());
+            file.write(reinterpret_cast<const char*>(buffer.data()), valid * sizeof(EphemerisRecord));
+            written += valid;
+            if (valid < n)
+                break;
+        }
+        return written;
+    }
+
+    unsigned Threads() const { return this->threadCount; }
+
+private:
+    libsgp4::SGP4 sgp4;
+    double epochDays;
+    unsigned threadCount;
+
+    // Runs sample(i) for i in [0, count) across the worker threads. Each worker propagates with its
+    // own copy of the SGP4 state. Returns the length of the prefix that propagated without error.
+    template <typename Sample>
+    size_t Run(size_t count, Sample sample) const
+    {
+        size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        std::atomic<size_t> nextChunk(0);
+        std::atomic<size_t> firstFailure(count);
+
+        auto worker = [&]() {
+            libsgp4::SGP4 local(this->sgp4);
+            for (size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++)
+            {
+                Metrics::Instance().Set(METRIC_WORKER_QUEUE_DEPTH, (int64_t)(chunks - chunk - 1));
+                size_t begin = chunk * CHUNK_SIZE;
+                size_t end = std::min(begin + CHUNK_SIZE, count);
+                if (begin >= firstFailure.load(std::memory_order_relaxed))
+                    continue;
+                size_t i = begin;
+                for (; i < end; ++i)
+                {
+                    try
+                    {
+                        sample(local, i);
+                    }
+                    catch (const std::exception&)
+                    {
+                        // Decayed or invalid state; everything from here on is unusable
+                        size_t seen = firstFailure.load();
+                        while (i < seen && !firstFailure.compare_exchange_weak(seen, i))
+                        {
+                        }
+                        Metrics::Instance().Add(METRIC_PROPAGATION_FAILURES);
+                        break;
+                    }
+                }
+                Metrics::Instance().Add(METRIC_PROPAGATIONS, i - begin);
+            }
+        };
+
+        unsigned workers = static_cast<unsigned>(std::min<size_t>(this->threadCount, chunks));
+        if (workers <= 1)
+        {
+            worker();
+        }
+        else
+        {
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+            for (unsigned t = 1; t < workers; ++t)
+                pool.emplace_back(worker);
+            worker();
+            for (std::thread& thread : pool)
+                thread.join();
+        }
+        return firstFailure.load();
+    }
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+// Std. Includes
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+// GL Includes
+#include <GL/glew.h>
+#include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/type_ptr.hpp>
+
+#include "Shader.h"
+#include "Metrics.h"
+
+// Fading trails and sub-satellite ground tracks for every object.
+//
+// All samples live in one texture buffer laid out slot-major: ring slot s holds one vec4 per object,
+// so appending the newest positions of the whole catalog is a single glBufferSubData of one slot.
+// Trails and ground tracks come from the same samples (the ground track is the radial projection onto
+// the Earth's surface, done in the vertex shader) and are drawn with one instanced line-strip call:
+// instances [0, N) are trails, [N, 2N) ground tracks. Memory is ringLength * N * 16 bytes and is only
+// reallocated when the number of objects changes.
+class TrailRenderer
+{
+public:
+    // Simulation seconds between two samples
+    double SampleInterval;
+    glm::vec3 TrailColor;
+    glm::vec3 GroundColor;
+    // Ground tracks sit slightly above the unit sphere so they don't z-fight with the Earth
+    float GroundRadius;
+
+    explicit TrailRenderer(size_t ringLength = 256)
+        : SampleInterval(30.0), TrailColor(1.0f, 0.8f, 0.3f), GroundColor(0.3f, 1.0f, 0.5f), GroundRadius(1.003f),
+          ringLength(ringLength), objectCount(0), head(0), filled(0), lastDays(0.0), VAO(0), buffer(0), texture(0)
+    {
+    }
+
+    // Appends positions (scene frame, one per object) if at least SampleInterval has passed since the last sample.
+    // A change in object count or a jump back in time restarts all trails; a reload that keeps the count
+    // must call Clear() itself.
+    void Append(double days, const glm::vec3* positions, size_t count)
+    {
+        if (!this->VAO)
+            this->Init();
+        if (count != this->objectCount)
+            this->Resize(count);
+        else if (this->filled > 0 && days < this->lastDays)
+            this->Clear();
+        if (this->filled > 0 && (days - this->lastDays) * 86400.0 < this->SampleInterval)
+            return;
+        if (count == 0)
+            return;
+
+        this->head = (this->head + 1) % this->ringLength;
+        for (size_t i = 0; i < count; ++i)
+            this->staging[i] = glm::vec4(positions[i], 1.0f);
+        glBindBuffer(GL_TEXTURE_BUFFER, this->buffer);
+        glBufferSubData(GL_TEXTURE_BUFFER, this->head * count * sizeof(glm::vec4), count * sizeof(glm::vec4), this->staging.data());
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        Metrics::Instance().Add(METRIC_UPLOAD_BYTES, count * sizeof(glm::vec4));
+        this->filled = std::min(this->filled + 1, this->ringLength);
+        this->lastDays = days;
+    }
+
+    void Draw(Shader& shader, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection)
+    {
+        if (this->filled < 2 || this->objectCount == 0)
+            return;
+        shader.Use();
+        shader.setMat4("model", model);
+        shader.setMat4("view", view);
+        shader.setMat4("projection", projection);
+        glUniform1i(glGetUniformLocation(shader.Program, "trail"), 0);
+        glUniform1i(glGetUniformLocation(shader.Program, "ringLength"), (GLint)this->ringLength);
+        glUniform1i(glGetUniformLocation(shader.Program, "objectCount"), (GLint)this->objectCount);
+        glUniform1i(glGetUniformLocation(shader.Program, "head"), (GLint)this->head);
+        glUniform1f(glGetUniformLocation(shader.Program, "groundRadius"), this->GroundRadius);
+        glUniform3f(glGetUniformLocation(shader.Program, "trailColor"), this->TrailColor.x, this->TrailColor.y, this->TrailColor.z);
+        glUniform3f(glGetUniformLocation(shader.Program, "groundColor"), this->GroundColor.x, this->GroundColor.y, this->GroundColor.z);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(this->VAO);
+        glDrawArraysInstanced(GL_LINE_STRIP, 0, (GLsizei)this->filled, (GLsizei)(this->objectCount * 2));
+        glBindVertexArray(0);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void Clear()
+    {
+        this->head = 0;
+        this->filled = 0;
+    }
+
+    size_t BufferBytes() const { return this->ringLength * this->objectCount * sizeof(glm::vec4); }
+
+    void Release()
+    {
+        glDeleteVertexArrays(1, &this->VAO);
+        glDeleteBuffers(1, &this->buffer);
+        glDeleteTextures(1, &this->texture);
+        this->VAO = this->buffer = this->texture = 0;
+    }
+
+private:
+    size_t ringLength;
+    size_t objectCount;
+    size_t head;        // slot of the newest sample
+    size_t filled;      // samples written since the last reset, at most ringLength
+    double lastDays;
+    GLuint VAO, buffer, texture;
+    std::vector<glm::vec4> staging;
+
+    void Init()
+    {
+        // Everything comes from gl_VertexID/gl_InstanceID and the texture buffer, but core profile still needs a VAO
+        glGenVertexArrays(1, &this->VAO);
+        glGenBuffers(1, &this->buffer);
+        glGenTextures(1, &this->texture);
+        glBindTexture(GL_TEXTURE_BUFFER, this->texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, this->buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void Resize(size_t count)
+    {
+        this->objectCount = count;
+        this->staging.resize(count);
+        glBindBuffer(GL_TEXTURE_BUFFER, this->buffer);
+        glBufferData(GL_TEXTURE_BUFFER, this->BufferBytes(), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        this->Clear();
+    }
+};
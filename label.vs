@@ -0,0 +1,25 @@
+#version 330 core
+layout (location = 0) in vec4 glyphRect;   // pixel offset from the anchor (y down) and size
+layout (location = 1) in vec4 glyphUV;
+layout (location = 2) in vec4 glyphColor;
+layout (location = 3) in float anchorSlot;
+
+out vec2 TexCoords;
+out vec4 Color;
+
+uniform mat4 viewProjection;
+uniform vec2 viewport;
+uniform samplerBuffer anchors;
+
+void main()
+{
+    // Quad corner from the vertex index of a 4-vertex triangle strip
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec4 clip = viewProjection * vec4(texelFetch(anchors, int(anchorSlot)).xyz, 1.0);
+    vec2 pixel = glyphRect.xy + corner * glyphRect.zw;
+    clip.xy += vec2(pixel.x, -pixel.y) * 2.0 / viewport * clip.w;
+    gl_Position = clip;
+
+    TexCoords = mix(glyphUV.xy, glyphUV.zw, corner);
+    Color = glyphColor;
+}
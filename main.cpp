@@ -14,6 +14,18 @@
 
 #include "Shader.h"
 #include "Camera.h"
+#include "OrbitMath.h"
+#include "TrackPropagator.h"
+#include "PropagationRegression.h"
+#include "Catalog.h"
+#include "LabelRenderer.h"
+#include "SessionRecorder.h"
+#include "ObserverGeometry.h"
+#include "TrailRenderer.h"
+#include "RegionQuery.h"
+#include "RenderScheduler.h"
+#include "SatelliteRenderer.h"
+#include "Metrics.h"
 //#include "Satpredictor.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
@@ -35,17 +47,15 @@ using namespace date;
 using namespace std::chrono; 
 using namespace libsgp4;
 
-#define PI 3.1415926535
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void refresh_callback(GLFWwindow* window);
 void Do_Movement();
 std::string tle_epoch_to_datetime(double tle_epoch);
 glm::vec3 calculate_iss_position_ecef(double t_seconds);
-glm::vec3 toGLMCoordinates(const glm::vec3& ecef);
-double calculate_days(const std::string& tle_epoch); 
-double gmst(double D);
 
 // Camera
 Camera camera(glm::vec3(1.0f, 0.0f, 0.0f));
@@ -156,10 +166,57 @@ bool speedChanged = false;
 float animationSpeed = 10.0f;
 bool is_paused = false;
 bool cameraMode = true; // true - камера управляется мышью, false - курсор виден
+bool reloadCatalog = false;
+SessionRecorder sessionRecorder;
+SessionReplayer sessionReplayer;
+RenderScheduler renderScheduler;
 const float orbitDuration = 8000;
-const double EARTH_RADIUS_KM = 6371.0;
+const std::string ISS_TLE_LINE1 = "1 25544U 98067A   25139.18441541  .00007929  00000+0  14879-3 0  9996";
+const std::string ISS_TLE_LINE2 = "2 25544  51.6355  90.7571 0002193 124.9576 235.1619 15.49604105510665";
+const std::string CATALOG_PATH = "catalog.tle";
+
+int main(int argc, char* argv[]) {    
+    // Метрики (перед остальными аргументами, работают и в консольных режимах):
+    // --metrics-port <port> - Prometheus на http://127.0.0.1:<port>/metrics, --metrics-file <path> - файл раз в 10 с
+    MetricsServer metricsServer;
+    MetricsFile metricsFile;
+    while (argc >= 3 && std::string(argv[1]).compare(0, 10, "--metrics-") == 0) {
+        std::string option = argv[1];
+        if (option == "--metrics-port")
+            metricsServer.Start(std::stoi(argv[2]));
+        else if (option == "--metrics-file")
+            metricsFile.Start(argv[2], 10.0);
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    // Headless accuracy/throughput regression: --regression <corpus.tle> <report.json> [baseline.json]
+    if (argc >= 4 && std::string(argv[1]) == "--regression") {
+        return run_propagation_regression(argv[2], argv[3], argc >= 5 ? argv[4] : "");
+    }
+    // Headless downlink geometry: --observer <catalog.tle> <stations.txt> <carrier MHz> <hours> <step s> <out.csv|out.bin>
+    if (argc >= 8 && std::string(argv[1]) == "--observer") {
+        return run_observer_grid(argv[2], argv[3], std::stod(argv[4]), std::stod(argv[5]), std::stod(argv[6]), argv[7]);
+    }
+    // Headless region query: --region <catalog.tle> <lat min> <lat max> <lon min> <lon max> <hours>
+    if (argc >= 8 && std::string(argv[1]) == "--region") {
+        return run_region_query(argv[2], std::stod(argv[3]), std::stod(argv[4]), std::stod(argv[5]), std::stod(argv[6]), std::stod(argv[7]));
+    }
+    // Benchmark sessions: --record <session.bin> | --replay <session.bin> [--report <timings.csv>]
+    std::string reportPath = "session_report.csv";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--record")
+            sessionRecorder.Open(argv[i + 1]);
+        else if (option == "--replay")
+            sessionReplayer.Open(argv[i + 1]);
+        else if (option == "--report")
+            reportPath = argv[i + 1];
+    }
+    // При воспроизведении рисуется каждый кадр, иначе замеры несравнимы
+    renderScheduler.Enabled = !sessionReplayer.Active();
+    FrameTimer frameTimer;
 
-int main() {    
     // Init GLFW
     glfwInit();
     // Set all the required options for GLFW
@@ -176,6 +233,8 @@ int main() {
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetWindowRefreshCallback(window, refresh_callback);
 
     // Options
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -203,6 +262,10 @@ int main() {
     Shader skyboxShader("D:/OpenGL_Projects/satellite_tracker/skybox.vs", "D:/OpenGL_Projects/satellite_tracker/skybox.frag");
     Shader satelliteShader("D:/OpenGL_Projects/satellite_tracker/satellite.vs", "D:/OpenGL_Projects/satellite_tracker/satellite.frag");
     Shader orbitShader("D:/OpenGL_Projects/satellite_tracker/orbit.vs", "D:/OpenGL_Projects/satellite_tracker/orbit.frag");
+    Shader labelShader("D:/OpenGL_Projects/satellite_tracker/label.vs", "D:/OpenGL_Projects/satellite_tracker/label.frag");
+    Shader trailShader("D:/OpenGL_Projects/satellite_tracker/trail.vs", "D:/OpenGL_Projects/satellite_tracker/trail.frag");
+    Shader satelliteInstancedShader("D:/OpenGL_Projects/satellite_tracker/satellite_instanced.vs", "D:/OpenGL_Projects/satellite_tracker/satellite_instanced.frag");
+    Shader presentShader("D:/OpenGL_Projects/satellite_tracker/present.vs", "D:/OpenGL_Projects/satellite_tracker/present.frag");
 
     float satelliteVertices[] = {
         // Нижнее основание (нижняя грань)
@@ -273,6 +336,11 @@ int main() {
     glEnableVertexAttribArray(0);
     glBindVertexArray(0);
 
+    // Каталог рисуется инстансами после отсечения: кубы вблизи, точки вдали
+    SatelliteCuller satelliteCuller;
+    SatelliteRenderer satelliteRenderer;
+    satelliteRenderer.Init(satVBO, satEBO, 36);
+
     GLuint lightVAO;
     glGenVertexArrays(1, &lightVAO);
     glBindVertexArray(lightVAO);
@@ -359,10 +427,10 @@ int main() {
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glBindVertexArray(0);
 
-    std::vector<glm::vec3> orbitPoints;
-    for (size_t i = 0; i != orbitDuration; ++i) {
-        orbitPoints.push_back(calculate_iss_position_ecef(i));
-    }
+    Tle issTle("ISS", ISS_TLE_LINE1, ISS_TLE_LINE2);
+    double issEpochDays = tle_line1_epoch_days(ISS_TLE_LINE1);
+    TrackPropagator issTrack(SGP4(issTle), issEpochDays);
+    std::vector<glm::vec3> orbitPoints = issTrack.Propagate(issEpochDays, 1.0, static_cast<size_t>(orbitDuration));
     
     GLuint orbitVAO, orbitVBO;
     glGenVertexArrays(1, &orbitVAO);
@@ -375,7 +443,32 @@ int main() {
 
     glBindVertexArray(0);
 
+    // Каталог спутников (необязательный): catalog.tle рядом с исполняемым файлом, R - перечитать
+    Catalog catalog;
+    catalog.LoadFromFile(CATALOG_PATH);
+    std::vector<glm::vec3> catalogPositions(catalog.Size());
+    CatalogHandle selectedSatellite = INVALID_CATALOG_HANDLE; // INVALID - выбрана МКС
+
+    LabelRenderer labelRenderer;
+    TrailRenderer trailRenderer;
+    std::vector<glm::vec3> trailPositions; // МКС + каталог
+    std::vector<Label> labels;
+    glm::mat4 sceneModel = glm::mat4(1.0f);
+    sceneModel = glm::rotate(sceneModel, -90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+    sceneModel = glm::scale(sceneModel, glm::vec3(0.2f));
+
     while (!glfwWindowShouldClose(window)) {
+        // Кадр рисуется, только если что-то изменилось; иначе ждём событий
+        RenderPass pass = renderScheduler.WaitForFrame(!is_paused);
+        for (Shader* shader : { &ourShader, &lightShader, &skyboxShader, &satelliteShader, &orbitShader, &labelShader, &trailShader, &satelliteInstancedShader, &presentShader }) {
+            if (shader->ReloadIfChanged())
+                renderScheduler.Mark(DIRTY_SCENE);
+        }
+        if (pass == RENDER_PASS_NONE) {
+            lastFrame = glfwGetTime();
+            continue;
+        }
+
         ImGuiIO& io = ImGui::GetIO();
         if (cameraMode) {
             io.WantCaptureMouse = false; // Позволяем камере получать события мыши
@@ -384,37 +477,19 @@ int main() {
             io.WantCaptureMouse = true; // Даем ImGui управление курсором
         }
         
-        GLfloat currentFrame = glfwGetTime();
+        // При воспроизведении время кадра фиксированное, а не по часам
+        GLfloat currentFrame = sessionReplayer.Active() ? lastFrame + sessionReplayer.FixedStep : glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
-        glfwPollEvents();
         Do_Movement();
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        ourShader.Use();
-        GLint lightPosLoc = glGetUniformLocation(ourShader.Program, "lightPos");
-        GLint objectColorLoc = glGetUniformLocation(ourShader.Program, "objectColor");
-        GLint lightColorLoc = glGetUniformLocation(ourShader.Program, "lightColor");
-        glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z);
-        glUniform3f(objectColorLoc, 1.0f, 0.0f, 0.0f);
-        glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f);
-        glm::mat4 model = glm::mat4(1.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        glm::mat4 projection = glm::perspective(45.0f, (GLfloat)WIDTH / (GLfloat)HEIGHT, 0.1f, 100.0f);
-        model = glm::scale(model, glm::vec3(0.2f));
-        GLint modelLoc = glGetUniformLocation(ourShader.Program, "model");
-        GLint viewLoc = glGetUniformLocation(ourShader.Program, "view");
-        GLint projLoc = glGetUniformLocation(ourShader.Program, "projection");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glBindVertexArray(VAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
-        glDrawElements(GL_TRIANGLE_STRIP, CScene::numberOfIndices, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
+        SessionFrame replayFrame;
+        if (sessionReplayer.Active()) {
+            if (!sessionReplayer.NextFrame(replayFrame))
+                break;
+            camera.SetState(replayFrame.cameraPosition, replayFrame.yaw, replayFrame.pitch, replayFrame.zoom);
+            cameraMode = replayFrame.cameraMode != 0;
+            frameTimer.BeginFrame();
+        }
         if (!is_paused) {
             if (speedChanged) {
                 simulationTime += deltaTime * prevAnimationSpeed;
@@ -425,27 +500,163 @@ int main() {
                 simulationTime += deltaTime * animationSpeed;
             }
         }
+        if (sessionReplayer.Active()) {
+            simulationTime = replayFrame.simulationTime;
+            animationSpeed = replayFrame.animationSpeed;
+            is_paused = replayFrame.paused != 0;
+        }
+        sessionRecorder.RecordFrame({ deltaTime, simulationTime, animationSpeed, (uint8_t)is_paused, (uint8_t)cameraMode,
+                                      camera.Position, camera.Yaw, camera.Pitch, camera.Zoom });
 
-        satelliteShader.Use();
         double tle_epoch = 25139.18441541;
         float currentTime = glfwGetTime();
         float normalizedTime = fmod(simulationTime, orbitDuration);
         glm::vec3 currentPosition =calculate_iss_position_ecef(normalizedTime);
-        modelLoc = glGetUniformLocation(lightShader.Program, "model");
-        viewLoc = glGetUniformLocation(lightShader.Program, "view");
-        projLoc = glGetUniformLocation(lightShader.Program, "projection");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glm::mat4 satmodel = glm::mat4(1.0f);
-        satmodel = glm::rotate(satmodel, -90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-        satmodel = glm::scale(satmodel, glm::vec3(0.2f));
-        satmodel = glm::translate(satmodel, currentPosition);
-        satmodel = glm::scale(satmodel, glm::vec3(0.01f));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(satmodel));
-        glBindVertexArray(satVAO);
-        glDrawElements(GL_TRIANGLE_STRIP, 36, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+        if (reloadCatalog) {
+            // Handles survive the reload for objects that are still in the file
+            catalog.LoadFromFile(CATALOG_PATH);
+            catalogPositions.resize(catalog.Size());
+            if (!catalog.IsValid(selectedSatellite))
+                selectedSatellite = INVALID_CATALOG_HANDLE;
+            // Slot i may now hold a different object even if the count is unchanged
+            trailRenderer.Clear();
+            reloadCatalog = false;
+            renderScheduler.Mark(DIRTY_CATALOG);
+        }
+        double catalogDays = issEpochDays + normalizedTime / 86400.0;
+
+        MetricTimer frameCpuTimer;
+        MetricTimer passTimer;
+        if (pass == RENDER_PASS_SCENE) {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            ourShader.Use();
+            GLint lightPosLoc = glGetUniformLocation(ourShader.Program, "lightPos");
+            GLint objectColorLoc = glGetUniformLocation(ourShader.Program, "objectColor");
+            GLint lightColorLoc = glGetUniformLocation(ourShader.Program, "lightColor");
+            glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z);
+            glUniform3f(objectColorLoc, 1.0f, 0.0f, 0.0f);
+            glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f);
+            glm::mat4 model = glm::mat4(1.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::mat4 projection = glm::perspective(45.0f, (GLfloat)WIDTH / (GLfloat)HEIGHT, 0.1f, 100.0f);
+            model = glm::scale(model, glm::vec3(0.2f));
+            GLint modelLoc = glGetUniformLocation(ourShader.Program, "model");
+            GLint viewLoc = glGetUniformLocation(ourShader.Program, "view");
+            GLint projLoc = glGetUniformLocation(ourShader.Program, "projection");
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+            glBindVertexArray(VAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+            glDrawElements(GL_TRIANGLE_STRIP, CScene::numberOfIndices, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+
+            satelliteShader.Use();
+            modelLoc = glGetUniformLocation(lightShader.Program, "model");
+            viewLoc = glGetUniformLocation(lightShader.Program, "view");
+            projLoc = glGetUniformLocation(lightShader.Program, "projection");
+            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+            glm::mat4 satmodel = glm::mat4(1.0f);
+            satmodel = glm::rotate(satmodel, -90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+            satmodel = glm::scale(satmodel, glm::vec3(0.2f));
+            satmodel = glm::translate(satmodel, currentPosition);
+            satmodel = glm::scale(satmodel, glm::vec3(0.01f));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(satmodel));
+            glBindVertexArray(satVAO);
+            glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+
+            passTimer.Restart();
+            catalog.PropagateScene(catalogDays, catalogPositions.data());
+            passTimer.Lap(METRIC_PASS_PROPAGATION);
+            // Радиус описанной сферы куба в мировых координатах (сцена масштабирована на 0.2)
+            float satelliteRadius = 0.5f * satelliteRenderer.CubeScale * 0.2f * 1.7320508f;
+            satelliteCuller.Cull(catalogPositions.data(), catalogPositions.size(), sceneModel, view, projection, camera.Position,
+                                 satelliteRadius, 0.2f, HEIGHT);
+            satelliteRenderer.Upload(satelliteCuller);
+            satelliteRenderer.Draw(satelliteInstancedShader, sceneModel, view, projection);
+            passTimer.Lap(METRIC_PASS_SATELLITES);
+
+            orbitShader.Use();
+            glm::mat4 orbitModel = glm::mat4(1.0f);
+            orbitModel = glm::scale(orbitModel, glm::vec3(0.2f));
+            orbitModel = glm::rotate(orbitModel, -90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+            glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "model"), 1, GL_FALSE, glm::value_ptr(orbitModel));
+            glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniform3f(glGetUniformLocation(orbitShader.Program, "lineColor"), 0.5f, 0.8f, 1.0f);
+            glBindVertexArray(orbitVAO);
+            glDrawArrays(GL_LINE_STRIP, 0, orbitPoints.size());
+            glBindVertexArray(0);
+
+            // Следы и наземные трассы: одна запись в буфер за кадр, один вызов отрисовки
+            trailPositions.resize(catalog.Size() + 1);
+            trailPositions[0] = currentPosition;
+            std::copy(catalogPositions.begin(), catalogPositions.end(), trailPositions.begin() + 1);
+            trailRenderer.Append(catalogDays, trailPositions.data(), trailPositions.size());
+            trailRenderer.Draw(trailShader, sceneModel, view, projection);
+            passTimer.Lap(METRIC_PASS_TRAILS);
+
+            lightShader.Use();
+            lightPosLoc = glGetUniformLocation(lightShader.Program, "lightPos");
+            modelLoc = glGetUniformLocation(lightShader.Program, "model");
+            viewLoc = glGetUniformLocation(lightShader.Program, "view");
+            projLoc = glGetUniformLocation(lightShader.Program, "projection");
+            glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z);
+            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+            model = glm::mat4();
+            model = glm::translate(model, lightPos);
+            model = glm::scale(model, glm::vec3(0.05f));
+            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glBindVertexArray(lightVAO);
+            glDrawElements(GL_TRIANGLE_STRIP, CScene::numberOfIndices, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+
+            glDepthFunc(GL_LEQUAL);
+            skyboxShader.Use();
+            view = glm::mat4(glm::mat3(camera.GetViewMatrix())); 
+            projection = glm::perspective(45.0f, (float)WIDTH / HEIGHT, 0.1f, 100.0f);
+            skyboxShader.setMat4("view", view);
+            skyboxShader.setMat4("projection", projection);
+
+            glBindVertexArray(skyboxVAO);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_CUBE_MAP, skyTexture);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            glBindVertexArray(0);
+            glDepthFunc(GL_LESS);
+
+            passTimer.Restart();
+            // Подписи спутников: выбранный спутник первым, остальные по близости к камере
+            labels.clear();
+            bool issSelected = !catalog.IsValid(selectedSatellite);
+            size_t selectedCatalogIndex = issSelected ? catalog.Size() : catalog.IndexOf(selectedSatellite);
+            labels.push_back({ glm::vec3(sceneModel * glm::vec4(currentPosition, 1.0f)), "ISS", issSelected ? 1e9f : 0.0f, glm::vec4(1.0f, 1.0f, 0.0f, 1.0f) });
+            for (size_t i = 0; i < catalog.Size(); ++i) {
+                glm::vec3 world = glm::vec3(sceneModel * glm::vec4(catalogPositions[i], 1.0f));
+                bool selected = i == selectedCatalogIndex;
+                labels.push_back({ world, catalog.InfoAt(i).name, selected ? 1e9f : 1.0f / glm::length(world - camera.Position),
+                                   selected ? glm::vec4(1.0f, 1.0f, 0.0f, 1.0f) : glm::vec4(0.8f, 0.9f, 1.0f, 0.9f) });
+            }
+            glm::mat4 sceneViewProjection = projection * camera.GetViewMatrix();
+            uint64_t selectionKey = issSelected ? 0 : ((uint64_t)selectedSatellite.slot << 32 | selectedSatellite.generation) + 1;
+            labelRenderer.Update(labels, sceneViewProjection, camera.Position, WIDTH, HEIGHT, selectionKey, currentFrame, 0.2f);
+            labelRenderer.Draw(labelShader, sceneViewProjection, WIDTH, HEIGHT);
+            passTimer.Lap(METRIC_PASS_LABELS);
+
+            // Копия сцены без ImGui для кадров, где меняется только интерфейс
+            renderScheduler.CaptureScene(WIDTH, HEIGHT);
+        }
+        else {
+            renderScheduler.DrawCachedScene(presentShader);
+        }
 
+        passTimer.Restart();
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
@@ -488,56 +699,47 @@ int main() {
             }
             ImGui::Text("Current speed: %.1fx", is_paused ? 0.0f : animationSpeed);
             ImGui::Text("Orbit time: %.1f / %.1f sec", fmod(simulationTime, orbitDuration), orbitDuration);
+            ImGui::Separator();
+            ImGui::Text("Catalog: %zu objects, %zu TLE errors, %zu bytes/object", catalog.Size(), catalog.ParseErrors(), catalog.BytesPerObject());
+            ImGui::Text("Drawn: %zu cubes, %zu points (%zu vertices), culled %zu, behind Earth %zu", satelliteRenderer.CubeCount(),
+                        satelliteRenderer.PointCount(), satelliteRenderer.VertexCount(), satelliteCuller.Culled(), satelliteCuller.Occluded());
+            if (catalog.Size() > 0) {
+                if (ImGui::Button("<")) {
+                    selectedSatellite = catalog.HandleAt(catalog.IsValid(selectedSatellite) ? (catalog.IndexOf(selectedSatellite) + catalog.Size() - 1) % catalog.Size() : catalog.Size() - 1);
+                    renderScheduler.Mark(DIRTY_CATALOG);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button(">")) {
+                    selectedSatellite = catalog.HandleAt(catalog.IsValid(selectedSatellite) ? (catalog.IndexOf(selectedSatellite) + 1) % catalog.Size() : 0);
+                    renderScheduler.Mark(DIRTY_CATALOG);
+                }
+                ImGui::SameLine();
+            }
+            std::string selectedName = catalog.IsValid(selectedSatellite) ? std::string(catalog.InfoAt(catalog.IndexOf(selectedSatellite)).name) : "ISS";
+            ImGui::Text("Selected: %s", selectedName.c_str());
         }
         ImGui::End();
 
-        orbitShader.Use();
-        glm::mat4 orbitModel = glm::mat4(1.0f);
-        orbitModel = glm::scale(orbitModel, glm::vec3(0.2f));
-        orbitModel = glm::rotate(orbitModel, -90.0f, glm::vec3(1.0f, 0.0f, 0.0f));
-        glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "model"), 1, GL_FALSE, glm::value_ptr(orbitModel));
-        glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(orbitShader.Program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform3f(glGetUniformLocation(orbitShader.Program, "lineColor"), 0.5f, 0.8f, 1.0f);
-        glBindVertexArray(orbitVAO);
-        glDrawArrays(GL_LINE_STRIP, 0, orbitPoints.size());
-        glBindVertexArray(0);
-
-        lightShader.Use();
-        lightPosLoc = glGetUniformLocation(lightShader.Program, "lightPos");
-        modelLoc = glGetUniformLocation(lightShader.Program, "model");
-        viewLoc = glGetUniformLocation(lightShader.Program, "view");
-        projLoc = glGetUniformLocation(lightShader.Program, "projection");
-        glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z);
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        model = glm::mat4();
-        model = glm::translate(model, lightPos);
-        model = glm::scale(model, glm::vec3(0.05f));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glBindVertexArray(lightVAO);
-        glDrawElements(GL_TRIANGLE_STRIP, CScene::numberOfIndices, GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        glDepthFunc(GL_LEQUAL);
-        skyboxShader.Use();
-        view = glm::mat4(glm::mat3(camera.GetViewMatrix())); 
-        projection = glm::perspective(45.0f, (float)WIDTH / HEIGHT, 0.1f, 100.0f);
-        skyboxShader.setMat4("view", view);
-        skyboxShader.setMat4("projection", projection);
-
-        glBindVertexArray(skyboxVAO);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, skyTexture);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        glBindVertexArray(0);
-        glDepthFunc(GL_LESS);
-
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        passTimer.Lap(METRIC_PASS_IMGUI);
         
         glfwSwapBuffers(window);
+        frameCpuTimer.Lap(pass == RENDER_PASS_SCENE ? METRIC_FRAME_SCENE : METRIC_FRAME_UI);
+        Metrics::Instance().Add(METRIC_FRAMES);
+        renderScheduler.FrameDone(pass);
+        if (sessionReplayer.Active())
+            frameTimer.EndFrame();
+    }
+    if (sessionReplayer.Active()) {
+        frameTimer.WriteReport(reportPath);
+        std::cout << "Replay finished, " << sessionReplayer.Events() << " input events, timings in " << reportPath << std::endl;
     }
+    sessionRecorder.Close();
+    labelRenderer.Release();
+    trailRenderer.Release();
+    renderScheduler.Release();
+    satelliteRenderer.Release();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -549,6 +751,9 @@ int main() {
 
 void Do_Movement()
 {
+    // Пока клавиша зажата, камера движется без новых событий
+    if (keys[GLFW_KEY_W] || keys[GLFW_KEY_S] || keys[GLFW_KEY_A] || keys[GLFW_KEY_D])
+        renderScheduler.Mark(DIRTY_CAMERA);
     if (keys[GLFW_KEY_W])
         camera.ProcessKeyboard(FORWARD, deltaTime);
     if (keys[GLFW_KEY_S])
@@ -561,10 +766,16 @@ void Do_Movement()
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
+    sessionRecorder.RecordKey(key, action);
+    renderScheduler.Mark(key == GLFW_KEY_W || key == GLFW_KEY_S || key == GLFW_KEY_A || key == GLFW_KEY_D ? DIRTY_CAMERA : DIRTY_UI);
+    if (sessionReplayer.Active() && key != GLFW_KEY_ESCAPE)
+        return;
     if (key == GLFW_KEY_TAB && action == GLFW_PRESS) {
         cameraMode = !cameraMode;
         glfwSetInputMode(window, GLFW_CURSOR, cameraMode ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);        
     }
+    if (key == GLFW_KEY_R && action == GLFW_PRESS && cameraMode)
+        reloadCatalog = true;
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
     if (key >= 0 && key < 1024)
@@ -578,6 +789,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
+    sessionRecorder.RecordCursor(xpos, ypos);
+    renderScheduler.Mark(cameraMode ? DIRTY_CAMERA : DIRTY_UI);
+    if (sessionReplayer.Active()) return;
     if (!cameraMode) return;
     if (firstMouse)
     {
@@ -597,9 +811,22 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    sessionRecorder.RecordScroll(yoffset);
+    renderScheduler.Mark(DIRTY_CAMERA);
+    if (sessionReplayer.Active()) return;
     camera.ProcessMouseScroll(yoffset);
 }
 
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    renderScheduler.Mark(DIRTY_UI);
+}
+
+void refresh_callback(GLFWwindow* window)
+{
+    renderScheduler.Mark(DIRTY_SCENE);
+}
+
 std::string tle_epoch_to_datetime(double tle_epoch) {
     using namespace date;
     using namespace std::chrono;
@@ -627,80 +854,9 @@ std::string tle_epoch_to_datetime(double tle_epoch) {
 }
 
 glm::vec3 calculate_iss_position_ecef(double t_seconds) {
-    const std::string tle_line1 = "1 25544U 98067A   25139.18441541  .00007929  00000+0  14879-3 0  9996";
-    const std::string tle_line2 = "2 25544  51.6355  90.7571 0002193 124.9576 235.1619 15.49604105510665";
-    Tle tle("ISS", tle_line1, tle_line2);
+    Tle tle("ISS", ISS_TLE_LINE1, ISS_TLE_LINE2);
 
     SGP4 sgp4(tle);
     Eci eci = sgp4.FindPosition(t_seconds/60); 
-    Vector position = eci.Position();  
-    double gmst_rad = gmst(calculate_days("25139.18441541")+(t_seconds /86400));
-    double cos_g = cos(gmst_rad);
-    double sin_g = sin(gmst_rad);
-    glm::dmat3 rotation_matrix{
-        cos_g,  sin_g, 0.0,
-        -sin_g, cos_g, 0.0,
-        0.0,    0.0,   1.0
-    };
-    glm::dvec3 eci_pos(-eci.Position().x, -eci.Position().y, eci.Position().z);
-    return toGLMCoordinates(glm::vec3(eci_pos * rotation_matrix));
-}
-
-glm::vec3 toGLMCoordinates(const glm::vec3& ecef) {
-    return glm::vec3(
-        ecef.x / EARTH_RADIUS_KM,
-        ecef.y / EARTH_RADIUS_KM,
-        ecef.z / EARTH_RADIUS_KM
-    );
-}
-
-double calculate_days(const std::string& tle_epoch) {
-    size_t dot_pos = tle_epoch.find('.');
-    std::string integer_part;
-    std::string fractional_part = "0";
-
-    if (dot_pos != std::string::npos) {
-        integer_part = tle_epoch.substr(0, dot_pos);
-        fractional_part = tle_epoch.substr(dot_pos + 1);
-    }
-    else {
-        integer_part = tle_epoch;
-    }
-
-    if (integer_part.size() != 5) {
-        throw std::invalid_argument("Invalid TLE epoch format");
-    }
-
-    int yy = stoi(integer_part.substr(0, 2));
-    int ddd = stoi(integer_part.substr(2, 3));
-    int Y = 2000 + yy;
-
-    bool is_leap = (Y % 4 == 0 && Y % 100 != 0) || (Y % 400 == 0);
-    int max_days = is_leap ? 366 : 365;
-    if (ddd < 1 || ddd > max_days) {
-        throw std::invalid_argument("Invalid day of year");
-    }
-
-    int years_count = Y - 2000;
-    int leap_count = 0;
-    for (int y = 2000; y < Y; ++y) {
-        if ((y % 4 == 0 && y % 100 != 0) || (y % 400 == 0)) {
-            leap_count++;
-        }
-    }
-
-    double days_before = years_count * 365 + leap_count + (ddd - 1);
-
-    double fractional = 0.0;
-    if (!fractional_part.empty()) {
-        fractional = stod("0." + fractional_part);
-    }
-    std::cout << fractional << std::endl;
-    return days_before + fractional;
+    return eci_to_scene(eci, calculate_days("25139.18441541")+(t_seconds /86400));
 }
-
-double gmst(double D) {
-    double T = D / 36525;
-    double GMST = 2*PI*(0.7790572732640 + 1.00273781191135448*D+(T*T)/(36525*365225)*(0.093104 - 0.0000062*T));
-    return GMST;
-}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+in vec2 TexCoords;
+out vec4 FragColor;
+
+uniform sampler2D scene;
+
+void main()
+{
+    FragColor = texture(scene, TexCoords);
+}
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform vec3 color;
+uniform bool points;
+
+void main()
+{
+    // Round sprites instead of squares
+    if (points && length(gl_PointCoord - vec2(0.5)) > 0.5)
+        discard;
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec3 aPosition;         // cube corner; constant (0,0,0) for point sprites
+layout (location = 1) in vec3 instancePosition;  // scene frame, Earth radii
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform float cubeScale;
+uniform float pointSize;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(instancePosition + aPosition * cubeScale, 1.0);
+    gl_PointSize = pointSize;
+}
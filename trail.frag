@@ -0,0 +1,16 @@
+#version 330 core
+in float Fade;
+in float Valid;
+flat in int Ground;
+out vec4 FragColor;
+
+uniform vec3 trailColor;
+uniform vec3 groundColor;
+
+void main()
+{
+    // Interpolated below 1 anywhere along a segment with an invalid end
+    if (Valid < 0.999)
+        discard;
+    FragColor = vec4(Ground == 1 ? groundColor : trailColor, Fade);
+}
@@ -0,0 +1,31 @@
+#version 330 core
+out float Fade;
+out float Valid;
+flat out int Ground;
+
+uniform samplerBuffer trail;   // ringLength slots of objectCount positions
+uniform int ringLength;
+uniform int objectCount;
+uniform int head;
+uniform float groundRadius;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    int object = gl_InstanceID % objectCount;
+    Ground = gl_InstanceID >= objectCount ? 1 : 0;
+
+    // Vertex 0 is the newest sample, older samples fade out
+    int age = gl_VertexID;
+    int slot = (head - age + ringLength) % ringLength;
+    vec3 position = texelFetch(trail, slot * objectCount + object).xyz;
+    // (0,0,0) is a position that was never propagated; segments touching it are dropped in trail.frag
+    Valid = length(position) > 0.0 ? 1.0 : 0.0;
+    if (Ground == 1 && Valid > 0.0)
+        position = normalize(position) * groundRadius; // sub-satellite point on the Earth surface
+    Fade = 1.0 - float(age) / float(ringLength);
+
+    gl_Position = projection * view * model * vec4(position, 1.0);
+}